@@ -1,5 +1,8 @@
 #include "integer.h"
 
+#include <cmath>
+#include <locale>
+
 constexpr INTEGER_DIGIT_T integer::NEG1;
 constexpr std::size_t     integer::OCTETS;
 constexpr std::size_t     integer::BITS;
@@ -7,9 +10,240 @@ constexpr INTEGER_DIGIT_T integer::HIGH_BIT;
 constexpr integer::Sign   integer::POSITIVE;
 constexpr integer::Sign   integer::NEGATIVE;
 
+integer::REP_SIZE_T integer::karatsuba_threshold = INTEGER_KARATSUBA_THRESHOLD;
+integer::REP_SIZE_T integer::toom3_threshold     = INTEGER_TOOM3_THRESHOLD;
+integer::REP_SIZE_T integer::toom4_threshold     = INTEGER_TOOM4_THRESHOLD;
+integer::REP_SIZE_T integer::ntt_threshold       = INTEGER_NTT_THRESHOLD;
+
+integer::REP_SIZE_T integer::burnikel_ziegler_threshold = INTEGER_BURNIKEL_ZIEGLER_THRESHOLD;
+integer::REP_SIZE_T integer::newton_threshold           = INTEGER_NEWTON_THRESHOLD;
+
+integer::REP_SIZE_T integer::redc_threshold = INTEGER_REDC_THRESHOLD;
+
+integer::REP_SIZE_T integer::from_chars_threshold = INTEGER_FROM_CHARS_THRESHOLD;
+
+// Memory resources
+namespace {
+
+thread_local integer_memory_resource * current_resource = nullptr;
+
+// bytes are handed out in multiples of this
+const std::size_t ALIGNMENT = alignof(std::max_align_t);
+
+}
+
+integer_memory_resource::~integer_memory_resource(){}
+
+integer_memory_resource * integer_memory_resource::current(){
+    return current_resource;
+}
+
+integer_memory_resource * integer_memory_resource::current(integer_memory_resource * resource){
+    std::swap(current_resource, resource);
+    return resource;
+}
+
+integer_memory_scope::integer_memory_scope(integer_memory_resource * resource) :
+    _previous(integer_memory_resource::current(resource))
+{}
+
+integer_memory_scope::~integer_memory_scope(){
+    integer_memory_resource::current(_previous);
+}
+
+integer_monotonic_resource::integer_monotonic_resource(const std::size_t & initial) :
+    _buffer(nullptr),
+    _size(0),
+    _current(nullptr),
+    _left(0),
+    _next(std::max(initial, ALIGNMENT)),
+    _blocks(nullptr)
+{}
+
+integer_monotonic_resource::integer_monotonic_resource(void * buffer, const std::size_t & size) :
+    _buffer(static_cast <char *> (buffer)),
+    _size(size),
+    _current(nullptr),
+    _left(0),
+    _next(std::max(size, static_cast <std::size_t> (4096))),
+    _blocks(nullptr)
+{
+    release();
+}
+
+integer_monotonic_resource::~integer_monotonic_resource(){
+    release();
+}
+
+void integer_monotonic_resource::release(){
+    while (_blocks){
+        void * previous = *static_cast <void **> (_blocks);
+        ::operator delete(_blocks);
+        _blocks = previous;
+    }
+
+    // start from the first aligned byte of the buffer
+    const std::size_t skip = _buffer?((ALIGNMENT - reinterpret_cast <std::uintptr_t> (_buffer) % ALIGNMENT) % ALIGNMENT):0;
+    _current = _buffer + std::min(skip, _size);
+    _left = _size - std::min(skip, _size);
+}
+
+void * integer_monotonic_resource::allocate(const std::size_t & bytes){
+    const std::size_t size = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    if (size > _left){
+        // each block starts with a link to the previous one, padded to keep the rest aligned
+        const std::size_t block = std::max(_next, size);
+        void * memory = ::operator new(ALIGNMENT + block);
+        *static_cast <void **> (memory) = _blocks;
+        _blocks = memory;
+        _current = static_cast <char *> (memory) + ALIGNMENT;
+        _left = block;
+        _next = block * 2;
+    }
+
+    void * out = _current;
+    _current += size;
+    _left -= size;
+    return out;
+}
+
+void integer_monotonic_resource::deallocate(void *, const std::size_t &){}
+
+// Scratch memory
+namespace {
+
+// Stack of memory for the temporary digits of the arithmetic kernels,
+// one per thread. Buffers are taken and given back in LIFO order through
+// scratch_buffer, and the memory is kept afterwards, so once the stack
+// has grown to fit the working set, the kernels stop allocating. It
+// always uses operator new, since it outlives any integer_memory_scope.
+class scratch_stack{
+    public:
+        // position to go back to when a buffer is given back
+        struct mark{
+            std::size_t block;
+            std::size_t used;
+        };
+
+    private:
+        struct block{
+            char *      data;
+            std::size_t size;
+        };
+
+        std::vector <block> _blocks;    // sizes only grow, so later blocks fit more
+        std::size_t         _block;     // block being handed out from
+        std::size_t         _used;      // bytes used in that block
+        std::size_t         _depth;     // buffers that have not been given back
+
+        void push(const std::size_t & size){
+            _blocks.push_back({static_cast <char *> (::operator new(size)), size});
+        }
+
+    public:
+        scratch_stack() :
+            _blocks(),
+            _block(0),
+            _used(0),
+            _depth(0)
+        {}
+
+        ~scratch_stack(){
+            for(const block & b : _blocks){
+                ::operator delete(b.data);
+            }
+        }
+
+        scratch_stack(const scratch_stack &) = delete;
+        scratch_stack & operator=(const scratch_stack &) = delete;
+
+        void * take(const std::size_t & bytes, mark & previous){
+            previous = {_block, _used};
+            _depth++;
+            if (!bytes){
+                return nullptr;
+            }
+
+            const std::size_t size = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+            while ((_block < _blocks.size()) && ((_used + size) > _blocks[_block].size)){
+                _block++;
+                _used = 0;
+            }
+            if (_block == _blocks.size()){
+                push(std::max(std::max(size, static_cast <std::size_t> (4096)), _blocks.empty()?0:(2 * _blocks.back().size)));
+            }
+
+            void * out = _blocks[_block].data + _used;
+            _used += size;
+            return out;
+        }
+
+        void give_back(const mark & previous){
+            _block = previous.block;
+            _used = previous.used;
+
+            // when nothing is in use, replace several blocks with one
+            // that holds all of them, so the next time everything fits
+            if (!--_depth && (_blocks.size() > 1)){
+                std::size_t total = 0;
+                for(const block & b : _blocks){
+                    total += b.size;
+                    ::operator delete(b.data);
+                }
+                _blocks.clear();
+                push(total);
+            }
+        }
+};
+
+scratch_stack & scratch(){
+    static thread_local scratch_stack stack;
+    return stack;
+}
+
+// Temporary array of a trivial type on the scratch stack of the calling
+// thread. Buffers have to be destroyed in the reverse order they were made,
+// which local variables are.
+template <typename T>
+class scratch_buffer{
+    static_assert(std::is_trivial <T>::value
+                  , "scratch_buffer only holds trivial types");
+
+    private:
+        scratch_stack::mark _previous;
+        T *                 _data;
+        std::size_t         _size;
+
+    public:
+        explicit scratch_buffer(const std::size_t & size) :
+            _previous(),
+            _data(static_cast <T *> (scratch().take(size * sizeof(T), _previous))),
+            _size(size)
+        {}
+
+        scratch_buffer(const std::size_t & size, const T & value) :
+            scratch_buffer(size)
+        {
+            std::fill(_data, _data + _size, value);
+        }
+
+        ~scratch_buffer(){
+            scratch().give_back(_previous);
+        }
+
+        scratch_buffer(const scratch_buffer &) = delete;
+        scratch_buffer & operator=(const scratch_buffer &) = delete;
+
+        T * data()                                const { return _data; }
+        std::size_t size()                        const { return _size; }
+        T & operator[](const std::size_t & i)     const { return _data[i]; }
+};
+
+}
+
 integer & integer::trim(){                  // remove top 0 digits to save memory
-    while (!_value.empty() && !_value[0]){
-        _value.pop_front();
+    while (!_value.empty() && !_value.back()){
+        _value.pop_back();
     }
     if (_value.empty()){                    // change sign to false if _value is 0
         _sign = integer::POSITIVE;
@@ -18,6 +252,21 @@ integer & integer::trim(){                  // remove top 0 digits to save memor
     return *this;
 }
 
+integer::REP_SIZE_T integer::bit_count() const {
+    if (_value.empty()){
+        return 0;
+    }
+
+    integer::REP_SIZE_T out = (_value.size() - 1) * integer::BITS;
+    INTEGER_DIGIT_T     msb = _value.back();
+    while (msb){
+        msb >>= 1;
+        out++;
+    }
+
+    return out;
+}
+
 // Constructors
 integer::integer() :
     _sign(integer::POSITIVE),
@@ -46,6 +295,13 @@ integer::integer(const integer::REP & rhs, const integer::Sign & sign) :
     trim();
 }
 
+integer::integer(integer::REP && rhs, const integer::Sign & sign) :
+    _sign(sign),
+    _value(std::move(rhs))
+{
+    trim();
+}
+
 integer::integer(const bool & b) :
     _sign(false),
     _value(1, b)
@@ -53,6 +309,71 @@ integer::integer(const bool & b) :
     trim();
 }
 
+integer::integer(const integer_view & view) :
+    _sign(view.sign()),
+    _value(view.data(), view.data() + view.digits())
+{}
+
+namespace {
+
+// value of each character as a digit, with both cases of a-f,
+// and 0xff for characters that are not digits in any base
+const uint8_t * digit_values(){
+    static const struct table{
+        uint8_t value[256];
+        table(){
+            std::fill(value, value + 256, 0xff);
+            for(uint8_t c = 0; c < 10; c++){
+                value['0' + c] = c;
+            }
+            for(uint8_t c = 0; c < 6; c++){
+                value['a' + c] = value['A' + c] = static_cast <uint8_t> (10 + c);
+            }
+        }
+    } values;
+    return values.value;
+}
+
+const char LOWER_DIGITS[] = "0123456789abcdef";
+const char UPPER_DIGITS[] = "0123456789ABCDEF";
+
+// whether the least significant byte of a digit is stored first
+bool little_endian_host(){
+    const INTEGER_DIGIT_T one = 1;
+    unsigned char first;
+    std::memcpy(&first, &one, 1);
+    return first;
+}
+
+// offset of byte i (counting from the least significant byte of the whole
+// value) in an array of count words of size bytes each
+struct byte_layout{
+    std::size_t count, size;
+    bool msw_first, big_endian;
+
+    byte_layout(const std::size_t & c, const std::size_t & s, const int & endian, const int & order)
+        : count(c), size(s), msw_first(order == 1), big_endian(endian?(endian == 1):!little_endian_host())
+    {
+        if (!size){
+            throw std::runtime_error("Error: Word size must be positive");
+        }
+    }
+
+    // the bytes are in the same order as the bytes of the digits
+    bool native() const {
+        return ((count == 1) || !msw_first) && ((size == 1) || !big_endian) && little_endian_host();
+    }
+
+    std::size_t operator()(const std::size_t & i) const {
+        const std::size_t word = i / size;
+        const std::size_t byte = i % size;
+        return (msw_first?(count - 1 - word):word) * size + (big_endian?(size - 1 - byte):byte);
+    }
+};
+
+
+}
+
 // Special Constructor for Strings
 // bases 2-16 and 256 are allowed
 //      Written by Corbin http://codereview.stackexchange.com/a/13452
@@ -79,35 +400,48 @@ integer::integer(const std::string & str, const integer & base) : integer()
             index++;
         }
 
-        // process characters
-        for(; index < str.size(); index++){
-            uint8_t d = std::tolower(str[index]);
-            if (std::isdigit(d)){       // 0-9
-                d -= '0';
-                if (d >= base){
-                    throw std::runtime_error(std::string("Error: Not a digit in base ") + base.str(10) + ": '"+ str[index] + "'");
-                }
+        const INTEGER_DIGIT_T b = base._value[0];
+
+        // every character has to be a digit
+        const uint8_t * values = digit_values();
+        for(std::string::size_type i = index; i < str.size(); i++){
+            if (values[static_cast <unsigned char> (str[i])] >= b){
+                throw std::runtime_error(std::string("Error: Not a digit in base ") + base.str(10) + ": '"+ str[i] + "'");
             }
-            else if (std::isxdigit(d)){ // a-f
-                d -= 'a' - 10;
-                if (d >= base){
-                    throw std::runtime_error(std::string("Error: Not a digit in base ") + base.str(10) + ": '"+ str[index] + "'");
-                }
+        }
+
+        // bases 2, 4, 8, and 16 have their bits placed directly into the digits
+        if (!(b & (b - 1))){
+            unsigned int shift = 1;
+            while ((static_cast <INTEGER_DIGIT_T> (1) << shift) < b){
+                shift++;
             }
-            else{                       // bad character
-                throw std::runtime_error(std::string("Error: Not a digit in base ") + base.str(10) + ": '"+ str[index] + "'");
+            from_pow2(str.data() + index, str.data() + str.size(), shift, values);
+        }
+        // other bases pack as many characters as fit into each chunk
+        else{
+            const integer::REP_SIZE_T per_chunk = chunk_digits(b);
+            std::vector <INTEGER_DIGIT_T> chunks;
+            chunks.reserve((str.size() - index) / per_chunk);
+            INTEGER_DIGIT_T tail = 0;
+            integer::REP_SIZE_T tail_digits = 0;
+            for(; index < str.size(); index++){
+                tail = static_cast <INTEGER_DIGIT_T> (tail * b + values[static_cast <unsigned char> (str[index])]);
+                if (++tail_digits == per_chunk){
+                    chunks.push_back(tail);
+                    tail = 0;
+                    tail_digits = 0;
+                }
             }
 
-            *this = (*this * base) + d;
+            *this = from_chunks(chunks, base, per_chunk, tail, tail_digits);
         }
 
         _sign = sign;
     }
     else if (base == 256){
-        // process characters
-        for(unsigned char const & c : str){
-            *this = (*this << 8) | (c & 0xff);
-        }
+        // each character is a byte, most significant first
+        import_bytes(*this, str.data(), str.size());
     }
     else{
         throw std::runtime_error("Error: Cannot convert from base " + base.str(10));
@@ -116,6 +450,104 @@ integer::integer(const std::string & str, const integer & base) : integer()
     trim();
 }
 
+integer::REP_SIZE_T integer::chunk_digits(const INTEGER_DIGIT_T & base){
+    if (base < 2){
+        return 1;
+    }
+
+    INTEGER_DIGIT_T chunk = base;
+    integer::REP_SIZE_T count = 1;
+    while (chunk <= integer::NEG1 / base){
+        chunk = static_cast <INTEGER_DIGIT_T> (chunk * base);
+        count++;
+    }
+    return count;
+}
+
+template <typename Chunk>
+integer integer::from_chunks(const std::vector <Chunk> & chunks, const integer & base, const integer::REP_SIZE_T & per_chunk, const INTEGER_DIGIT_T & tail, const integer::REP_SIZE_T & tail_digits){
+    // powers of 2 only need the chunks placed next to each other
+    if ((base._value.size() == 1) && !(base._value[0] & (base._value[0] - 1))){
+        unsigned int shift = 1;
+        while ((static_cast <INTEGER_DIGIT_T> (1) << shift) < base._value[0]){
+            shift++;
+        }
+
+        const integer::REP_SIZE_T group = per_chunk * shift;
+        const integer::REP_SIZE_T tail_bits = tail_digits * shift;
+
+        integer out;
+        out._value.resize((chunks.size() * group + tail_bits + integer::BITS - 1) / integer::BITS);
+        for(std::size_t i = 0; i <= chunks.size(); i++){
+            // the tail goes at the bottom
+            const INTEGER_DIGIT_T chunk = i?static_cast <INTEGER_DIGIT_T> (chunks[chunks.size() - i]):tail;
+            const integer::REP_SIZE_T bit = i?(tail_bits + (i - 1) * group):0;
+            const integer::REP_SIZE_T digit = bit / integer::BITS;
+            const std::size_t offset = bit % integer::BITS;
+            if (!chunk){
+                continue;
+            }
+
+            out._value[digit] |= static_cast <INTEGER_DIGIT_T> (chunk << offset);
+            if (offset && ((offset + group) > integer::BITS)){
+                out._value[digit + 1] |= static_cast <INTEGER_DIGIT_T> (chunk >> (integer::BITS - offset));
+            }
+        }
+
+        return out.trim();
+    }
+
+    // powers[i] = (base^per_chunk)^(2^i), enough to split the chunks in half
+    integer chunk_base = 1;
+    for(integer::REP_SIZE_T i = 0; i < per_chunk; i++){
+        chunk_base *= base;
+    }
+    std::vector <integer> powers(1, chunk_base);
+    while ((static_cast <std::size_t> (1) << powers.size()) < chunks.size()){
+        powers.push_back(powers.back().sqr());
+    }
+
+    integer out = combine_chunks(chunks, 0, chunks.size(), powers);
+
+    // the leftover digits only happen with bases that fit in a digit
+    if (tail_digits){
+        INTEGER_DIGIT_T scale = 1;
+        for(integer::REP_SIZE_T i = 0; i < tail_digits; i++){
+            scale = static_cast <INTEGER_DIGIT_T> (scale * base._value[0]);
+        }
+        out.mult_digit(scale, integer::POSITIVE);
+        out += tail;
+    }
+
+    return out;
+}
+
+template <typename Chunk>
+integer integer::combine_chunks(const std::vector <Chunk> & chunks, const std::size_t & first, const std::size_t & count, const std::vector <integer> & powers){
+    // runs of up to about 1024 bits are faster to combine one chunk at a time
+    if ((count * powers[0]._value.size()) <= (1024 / integer::BITS)){
+        integer out;
+        for(std::size_t i = first; i < first + count; i++){
+            out *= powers[0];
+            out += chunks[i];
+        }
+        return out;
+    }
+
+    // the low half is the largest power of 2 chunks that is smaller than count
+    std::size_t level = 0;
+    while ((static_cast <std::size_t> (2) << level) < count){
+        level++;
+    }
+    const std::size_t low = static_cast <std::size_t> (1) << level;
+
+    return combine_chunks(chunks, first, count - low, powers) * powers[level] + combine_chunks(chunks, first + count - low, low, powers);
+}
+
+// the iterator constructor uses both kinds of chunks
+template integer integer::from_chunks(const std::vector <integer> & chunks, const integer & base, const integer::REP_SIZE_T & per_chunk, const INTEGER_DIGIT_T & tail, const integer::REP_SIZE_T & tail_digits);
+template integer integer::from_chunks(const std::vector <INTEGER_DIGIT_T> & chunks, const integer & base, const integer::REP_SIZE_T & per_chunk, const INTEGER_DIGIT_T & tail, const integer::REP_SIZE_T & tail_digits);
+
 //  RHS input args only
 
 // Assignment Operators
@@ -126,9 +558,9 @@ integer & integer::operator=(const integer & rhs){
 }
 
 integer & integer::operator=(integer && rhs){
-    if (*this != rhs){
+    if (this != &rhs){
         _sign = rhs._sign;
-        _value = rhs._value;
+        _value = std::move(rhs._value);
         rhs = 0;
     }
     return trim();
@@ -140,7 +572,7 @@ integer::operator bool() const {
 }
 
 integer::operator uint8_t() const {
-    const uint8_t out = static_cast <uint8_t> (_value.empty()?0:_value.back() & 255);
+    const uint8_t out = static_cast <uint8_t> (_value.empty()?0:_value[0] & 255);
     return _sign?-out:out;
 }
 
@@ -149,7 +581,7 @@ integer::operator uint16_t() const {
 
     const integer::REP_SIZE_T d = std::min(digits(), std::max((integer::REP_SIZE_T) 2 / integer::OCTETS, (integer::REP_SIZE_T) 1));
     for(integer::REP_SIZE_T x = 0; x < d; x++){
-        out += static_cast <uint16_t> (_value[digits() - x - 1]) << (x * integer::BITS);
+        out += static_cast <uint16_t> (_value[x]) << (x * integer::BITS);
     }
 
     return _sign?-out:out;
@@ -160,7 +592,7 @@ integer::operator uint32_t() const {
 
     const integer::REP_SIZE_T d = std::min(digits(), std::max((integer::REP_SIZE_T) 4 / integer::OCTETS, (integer::REP_SIZE_T) 1));
     for(integer::REP_SIZE_T x = 0; x < d; x++){
-        out += static_cast <uint32_t> (_value[digits() - x - 1]) << (x * integer::BITS);
+        out += static_cast <uint32_t> (_value[x]) << (x * integer::BITS);
     }
 
     return _sign?-out:out;
@@ -171,14 +603,14 @@ integer::operator uint64_t() const {
 
     const integer::REP_SIZE_T d = std::min(digits(), std::max((integer::REP_SIZE_T) 8 / integer::OCTETS, (integer::REP_SIZE_T) 1));
     for(integer::REP_SIZE_T x = 0; x < d; x++){
-        out += static_cast <uint64_t> (_value[digits() - x - 1]) << (x * integer::BITS);
+        out += static_cast <uint64_t> (_value[x]) << (x * integer::BITS);
     }
 
     return _sign?-out:out;
 }
 
 integer::operator int8_t() const {
-    const int8_t out = static_cast <int8_t> (_value.empty()?0:_value.back() & 255);
+    const int8_t out = static_cast <int8_t> (_value.empty()?0:_value[0] & 255);
     return _sign?-out:out;
 }
 
@@ -187,7 +619,7 @@ integer::operator int16_t() const {
 
     const integer::REP_SIZE_T d = std::min(digits(), std::max((integer::REP_SIZE_T) 2 / integer::OCTETS, (integer::REP_SIZE_T) 1));
     for(integer::REP_SIZE_T x = 0; x < d; x++){
-        out += static_cast <int16_t> (_value[digits() - x - 1]) << (x * integer::BITS);
+        out += static_cast <int16_t> (_value[x]) << (x * integer::BITS);
     }
 
     return _sign?-out:out;
@@ -198,7 +630,7 @@ integer::operator int32_t() const {
 
     const integer::REP_SIZE_T d = std::min(digits(), std::max((integer::REP_SIZE_T) 4 / integer::OCTETS, (integer::REP_SIZE_T) 1));
     for(integer::REP_SIZE_T x = 0; x < d; x++){
-        out += static_cast <int32_t> (_value[digits() - x - 1]) << (x * integer::BITS);
+        out += static_cast <int32_t> (_value[x]) << (x * integer::BITS);
     }
 
     return _sign?-out:out;
@@ -209,107 +641,114 @@ integer::operator int64_t() const {
 
     const integer::REP_SIZE_T d = std::min(digits(), std::max((integer::REP_SIZE_T) 8 / integer::OCTETS, (integer::REP_SIZE_T) 1));
     for(integer::REP_SIZE_T x = 0; x < d; x++){
-        out += static_cast <int64_t> (_value[digits() - x - 1]) << (x * integer::BITS);
+        out += static_cast <int64_t> (_value[x]) << (x * integer::BITS);
     }
 
     return _sign?-out:out;
 }
 
 // Bitwise Operators
-integer integer::operator&(const integer & rhs) const {
-    integer::REP out;
-
-    const integer::REP_SIZE_T max_bits = std::max(bits(), rhs.bits());
-    const integer             left     = (    _sign == integer::POSITIVE)?*this:twos_complement(max_bits);
-    const integer             right    = (rhs._sign == integer::POSITIVE)?rhs:rhs.twos_complement(max_bits);
-
-    // AND matching digits
-    for(integer::REP::const_reverse_iterator i = left._value.rbegin(), j = right._value.rbegin(); (i != left._value.rend()) && (j != right._value.rend()); i++, j++){
-        out.push_front(*i & *j);
+template <typename Op>
+integer integer::bitwise(const integer & lhs, const integer & rhs, const Op & op, const bool & negative){
+    const integer::REP_SIZE_T max_bits = std::max(lhs.bit_count(), rhs.bit_count());
+    const integer::REP_SIZE_T width    = (max_bits + integer::BITS - 1) / integer::BITS;
+
+    // negative values are replaced by their two's complements,
+    // which are kept on the stack when they are small
+    const bool fits = (width <= integer::REP::inline_capacity);
+    INTEGER_DIGIT_T small[2 * integer::REP::inline_capacity];
+    scratch_buffer <INTEGER_DIGIT_T> complements(fits?0:((lhs._sign + rhs._sign) * width));
+    const INTEGER_DIGIT_T * left  = lhs._value.data();
+    const INTEGER_DIGIT_T * right = rhs._value.data();
+    integer::REP_SIZE_T lsize = lhs._value.size();
+    integer::REP_SIZE_T rsize = rhs._value.size();
+    INTEGER_DIGIT_T * next = fits?small:complements.data();
+    if (lhs._sign == integer::NEGATIVE){
+        twos_complement(next, left, lsize, max_bits);
+        left  = next;
+        lsize = width;
+        next += width;
+    }
+    if (rhs._sign == integer::NEGATIVE){
+        twos_complement(next, right, rsize, max_bits);
+        right = next;
+        rsize = width;
     }
 
-    // drop any digits that don't match up
+    // missing digits are 0
+    integer::REP out(negative?width:std::max(lsize, rsize));
+    for(integer::REP_SIZE_T i = 0; i < out.size(); i++){
+        out[i] = op((i < lsize)?left[i]:0, (i < rsize)?right[i]:0);
+    }
 
-    integer OUT(out, integer::POSITIVE);
-    if (_sign & rhs._sign){
-        OUT = OUT.twos_complement(max_bits);
+    if (negative){
+        twos_complement(out.data(), out.data(), out.size(), max_bits);
     }
 
-    return OUT.trim();
+    integer result(std::move(out), negative?integer::NEGATIVE:integer::POSITIVE);
+    result.trim();
+    return result;
 }
 
-integer & integer::operator&=(const integer & rhs){
-    return *this = *this & rhs;
+integer integer::operator&(const integer & rhs) const {
+    return bitwise(*this, rhs, [](const INTEGER_DIGIT_T & l, const INTEGER_DIGIT_T & r){ return static_cast <INTEGER_DIGIT_T> (l & r); }, _sign & rhs._sign);
 }
 
-integer integer::operator|(const integer & rhs) const {
-    const integer::REP_SIZE_T max_bits = std::max(bits(), rhs.bits());
-    const integer             left     = (    _sign == integer::POSITIVE)?*this:twos_complement(max_bits);
-    const integer             right    = (rhs._sign == integer::POSITIVE)?rhs:rhs.twos_complement(max_bits);
-
-    integer::REP out;
-    integer::REP::const_reverse_iterator i = left._value.rbegin(), j = right._value.rbegin();
-
-    // OR matching digits
-    for(; (i != left._value.rend()) && (j != right._value.rend()); i++, j++){
-        out.push_front(*i | *j);
-    }
-
-    // push rest of *this into value
-    while (i != left._value.rend()){
-        out.push_front(*i++);
+integer & integer::operator&=(const integer & rhs){
+    if ((_sign == integer::NEGATIVE) || (rhs._sign == integer::NEGATIVE)){
+        return *this = *this & rhs;
     }
 
-    // push rest of rhs into value
-    while (j != right._value.rend()){
-        out.push_front(*j++);
+    // drop any digits that don't match up
+    if (_value.size() > rhs._value.size()){
+        _value.resize(rhs._value.size());
     }
 
-    integer OUT(out, integer::POSITIVE);
-    if (_sign | rhs._sign){
-        OUT = OUT.twos_complement(max_bits);
+    for(integer::REP_SIZE_T i = 0; i < _value.size(); i++){
+        _value[i] &= rhs._value[i];
     }
 
-    return OUT.trim();
+    return trim();
 }
 
-integer & integer::operator|=(const integer & rhs){
-    return *this = *this | rhs;
+integer integer::operator|(const integer & rhs) const {
+    return bitwise(*this, rhs, [](const INTEGER_DIGIT_T & l, const INTEGER_DIGIT_T & r){ return static_cast <INTEGER_DIGIT_T> (l | r); }, _sign | rhs._sign);
 }
 
-integer integer::operator^(const integer & rhs) const {
-    const integer::REP_SIZE_T max_bits = std::max(bits(), rhs.bits());
-    const integer             left     = (    _sign == integer::POSITIVE)?*this:twos_complement(max_bits);
-    const integer             right    = (rhs._sign == integer::POSITIVE)?rhs:rhs.twos_complement(max_bits);
-
-    integer::REP out;
-    integer::REP::const_reverse_iterator i = left._value.rbegin(), j = right._value.rbegin();
-
-    // XOR matching digits
-    for(; (i != left._value.rend()) && (j != right._value.rend()); i++, j++){
-        out.push_front(*i ^ *j);
+integer & integer::operator|=(const integer & rhs){
+    if ((_sign == integer::NEGATIVE) || (rhs._sign == integer::NEGATIVE)){
+        return *this = *this | rhs;
     }
 
-    // push *this into value
-    while (i != left._value.rend()){
-        out.push_front(*i++);
+    if (_value.size() < rhs._value.size()){
+        _value.resize(rhs._value.size(), 0);
     }
 
-    // push rhs into value
-    while (j != right._value.rend()){
-        out.push_front(*j++);
+    for(integer::REP_SIZE_T i = 0; i < rhs._value.size(); i++){
+        _value[i] |= rhs._value[i];
     }
 
-    integer OUT(out, integer::POSITIVE);
-    if (_sign ^ rhs._sign){
-        OUT = OUT.twos_complement(max_bits);
-    }
+    return *this;
+}
 
-    return OUT.trim();
+integer integer::operator^(const integer & rhs) const {
+    return bitwise(*this, rhs, [](const INTEGER_DIGIT_T & l, const INTEGER_DIGIT_T & r){ return static_cast <INTEGER_DIGIT_T> (l ^ r); }, _sign ^ rhs._sign);
 }
 
 integer & integer::operator^=(const integer & rhs){
-    return *this = *this ^ rhs;
+    if ((_sign == integer::NEGATIVE) || (rhs._sign == integer::NEGATIVE)){
+        return *this = *this ^ rhs;
+    }
+
+    if (_value.size() < rhs._value.size()){
+        _value.resize(rhs._value.size(), 0);
+    }
+
+    for(integer::REP_SIZE_T i = 0; i < rhs._value.size(); i++){
+        _value[i] ^= rhs._value[i];
+    }
+
+    return trim();
 }
 
 integer integer::operator~() const {
@@ -321,108 +760,110 @@ integer integer::operator~() const {
     integer::REP out = _value;
 
     // invert whole digits
-    for(integer::REP_SIZE_T i = 1; i < out.size(); i++){
+    for(integer::REP_SIZE_T i = 0; i < (out.size() - 1); i++){
         out[i] ^= integer::NEG1;
     }
 
     INTEGER_DIGIT_T mask = HIGH_BIT;
-    while (!(out[0] & mask)){
+    while (!(out.back() & mask)){
         mask >>= 1;
     }
 
     // invert bits of partial digit
     while (mask){
-        out[0] ^= mask;
+        out.back() ^= mask;
         mask >>= 1;
     }
 
-    return integer(out, _sign);
+    return integer(std::move(out), _sign);
 }
 
 // Bit Shift Operators
-
-// left bit shift. sign is maintained
-integer integer::operator<<(const integer & shift) const {
-    if (!*this || !shift){
+integer & integer::lshift(const integer::REP_SIZE_T & shift){
+    if (_value.empty() || !shift){
         return *this;
     }
 
-    if (shift < 0){
-        throw std::runtime_error("Error: Negative shift amount");
-    }
+    const integer::REP_SIZE_T whole = shift / integer::BITS;   // number of zero digits to add to the bottom
+    const integer::REP_SIZE_T push  = shift % integer::BITS;   // push left by this many bits
+    const integer::REP_SIZE_T pull  = integer::BITS - push;    // pull "push" bits from the right
+    const integer::REP_SIZE_T old   = _value.size();
 
-    const std::pair <integer, integer> qr = dm(shift, integer::BITS);
-    const integer & whole      = qr.first;             // number of zeros to add to the back
-    const INTEGER_DIGIT_T push = qr.second;            // push left by this many bits
-    const INTEGER_DIGIT_T pull = integer::BITS - push; // pull "push" bits from the right
+    // only add the extra digit for shifting into if it will be used
+    _value.resize((bit_count() + shift + integer::BITS - 1) / integer::BITS, 0);
 
-    integer::REP out = _value;
+    // work from the top down so that digits are read before they are overwritten
+    for(integer::REP_SIZE_T i = _value.size(); i > whole; i--){
+        const integer::REP_SIZE_T src = i - 1 - whole;
+        INTEGER_DIGIT_T d = (src < old)?(_value[src] << push):0;
+        if (push && src){
+            d |= _value[src - 1] >> pull;
+        }
+        _value[i - 1] = d;
+    }
 
-    out.push_front(0);                                 // extra digit for shifting into
-    out.push_back(0);                                  // extra digit for shifting from
+    std::fill(_value.begin(), _value.begin() + whole, 0);
 
-    // do this part first to avoid shifting zeros
-    for(integer::REP_SIZE_T i = 0; i < (out.size() - 1); i++){
-        INTEGER_DOUBLE_DIGIT_T d = out[i];
-        d = (d << push) | (out[i + 1] >> pull);
-        out[i] = d & NEG1;
-        // out[i] = (out[i] << push) | (out[i + 1] >> pull);
-    }
+    return *this;
+}
 
-    if (!out[0]){                                      // if the top digit is still 0
-        out.pop_front();                               // remove it
+integer & integer::rshift(const integer::REP_SIZE_T & shift){
+    if (shift >= bit_count()){
+        return *this = 0;
     }
 
-    if (!whole){                                       // if there was no need for the 0 at the end
-        out.pop_back();                                // remove it
-    }
-    else{
-        // push back zeros, excluding the one already there
-        out.insert(out.end(), whole - 1, 0);
+    const integer::REP_SIZE_T whole = shift / integer::BITS;   // number of digits to drop off the bottom
+    const integer::REP_SIZE_T push  = shift % integer::BITS;   // push right by this many bits
+    const integer::REP_SIZE_T pull  = integer::BITS - push;    // pull "push" bits from the left
+    const integer::REP_SIZE_T size  = _value.size() - whole;
+
+    // work from the bottom up so that digits are read before they are overwritten
+    for(integer::REP_SIZE_T i = 0; i < size; i++){
+        INTEGER_DIGIT_T d = _value[i + whole] >> push;
+        if (push && ((i + whole + 1) < _value.size())){
+            d |= _value[i + whole + 1] << pull;
+        }
+        _value[i] = d;
     }
 
-    return integer(out, _sign);
+    _value.resize(size);
+
+    return trim();
 }
 
-integer & integer::operator<<=(const integer & shift){
-    return *this = *this << integer(shift);
+// left bit shift. sign is maintained
+integer integer::operator<<(const integer & shift) const {
+    integer out(*this);
+    out <<= shift;
+    return out;
 }
 
-// right bit shift. sign is maintained
-integer integer::operator>>(const integer & shift) const {
+integer & integer::operator<<=(const integer & shift){
     if (shift < 0){
         throw std::runtime_error("Error: Negative shift amount");
     }
 
-    if (shift >= bits()){
-        return 0;
-    }
-
-    const std::pair <integer, integer> qr = dm(shift, integer::BITS);
-    const integer & whole      = qr.first;             // number of digits to pop off
-    const INTEGER_DIGIT_T push = qr.second;            // push right by this many bits
-    const INTEGER_DIGIT_T pull = integer::BITS - push; // pull "push" bits from the left
+    return lshift(static_cast <uint64_t> (shift));
+}
 
-    integer::REP out = _value;
+// right bit shift. sign is maintained
+integer integer::operator>>(const integer & shift) const {
+    integer out(*this);
+    out >>= shift;
+    return out;
+}
 
-    // pop off whole digits
-    for(integer i = 0; i < whole; i++){
-        out.pop_back();
+integer & integer::operator>>=(const integer & shift){
+    if (shift < 0){
+        throw std::runtime_error("Error: Negative shift amount");
     }
 
-    if (push){
-        out.push_front(0);                             // extra 0 for shifting from
-        for(integer::REP_SIZE_T i = 1; i < out.size(); i++){
-            out[out.size() - i] = (out[out.size() - i - 1] << pull) | (out[out.size() - i] >> push);
-        }
-        out.pop_front();
+    // shifting by more bits than the value has always results in 0
+    if (shift.digits() > (sizeof(uint64_t) / integer::OCTETS)){
+        return *this = 0;
     }
 
-    return integer(out, _sign);
-}
-
-integer & integer::operator>>=(const integer & shift){
-    return *this = *this >> integer(shift);
+    return rshift(static_cast <uint64_t> (shift));
 }
 
 // Logical Operators
@@ -439,23 +880,34 @@ bool integer::operator!=(const integer & rhs) const {
     return !(*this == rhs);
 }
 
-// operator> not considering signs
-bool integer::gt(const integer & lhs, const integer & rhs) const {
-    if (lhs._value.size() > rhs._value.size()){
-        return true;
-    }
-    if (lhs._value.size() < rhs._value.size()){
-        return false;
-    }
-    if (lhs._value == rhs._value){
-        return false;
+int integer::compare(const INTEGER_DIGIT_T * lhs, const integer::REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const integer::REP_SIZE_T & rsize){
+    if (lsize != rsize){
+        return (lsize > rsize)?1:-1;
     }
-    for(integer::REP_SIZE_T i = 0; i < lhs._value.size(); i++){
-        if (lhs._value[i] != rhs._value[i]){
-            return lhs._value[i] > rhs._value[i];
+
+    // compare from the most significant digit down
+    for(integer::REP_SIZE_T i = lsize; i > 0; i--){
+        if (lhs[i - 1] != rhs[i - 1]){
+            return (lhs[i - 1] > rhs[i - 1])?1:-1;
         }
     }
-    return false;
+    return 0;
+}
+
+int integer::compare(const integer::Sign & sign, const INTEGER_DIGIT_T & digit) const {
+    const integer::Sign rsign = digit?sign:integer::POSITIVE;  // -0 is 0
+
+    if (_sign != rsign){
+        return (_sign == integer::NEGATIVE)?-1:1;
+    }
+
+    const int out = compare(_value.data(), _value.size(), &digit, digit?1:0);
+    return (_sign == integer::NEGATIVE)?-out:out;
+}
+
+// operator> not considering signs
+bool integer::gt(const integer_view & lhs, const integer_view & rhs){
+    return compare(lhs.data(), lhs.digits(), rhs.data(), rhs.digits()) > 0;
 }
 
 bool integer::operator>(const integer & rhs) const {
@@ -481,22 +933,8 @@ bool integer::operator>=(const integer & rhs) const {
 }
 
 // operator< not considering signs
-bool integer::lt(const integer & lhs, const integer & rhs) const {
-    if (lhs._value.size() < rhs._value.size()){
-        return true;
-    }
-    if (lhs._value.size() > rhs._value.size()){
-        return false;
-    }
-    if (lhs._value == rhs._value){
-        return false;
-    }
-    for(integer::REP_SIZE_T i = 0; i < lhs._value.size(); i++){
-        if (lhs._value[i] != rhs._value[i]){
-            return lhs._value[i] < rhs._value[i];
-        }
-    }
-    return false;
+bool integer::lt(const integer_view & lhs, const integer_view & rhs){
+    return compare(lhs.data(), lhs.digits(), rhs.data(), rhs.digits()) < 0;
 }
 
 bool integer::operator<(const integer & rhs) const {
@@ -522,114 +960,91 @@ bool integer::operator<=(const integer & rhs) const {
 }
 
 // Arithmetic Operators
-integer integer::add(const integer & lhs, const integer & rhs) const {
-    integer::REP out;
-    integer::REP::const_reverse_iterator i = lhs._value.rbegin(), j = rhs._value.rbegin();
-    bool carry = false;
-    INTEGER_DOUBLE_DIGIT_T sum;
-
-    // add up matching digits
-    for(; ((i != lhs._value.rend()) && (j != rhs._value.rend())); i++, j++){
-        sum = static_cast <INTEGER_DOUBLE_DIGIT_T> (*i) + static_cast <INTEGER_DOUBLE_DIGIT_T> (*j) + carry;
-        out.push_front(sum);
-        carry = (sum > integer::NEG1);
+void integer::add(integer::REP & lhs, const INTEGER_DIGIT_T * rhs, const integer::REP_SIZE_T & rsize){
+    // rhs only points into lhs when they are the same size,
+    // so lhs is never reallocated while rhs is still being read
+    if (lhs.size() < rsize){
+        lhs.resize(rsize, 0);
     }
 
-    // copy in lhs extra digits
-    for(; i != lhs._value.rend(); i++){
-        sum = static_cast <INTEGER_DOUBLE_DIGIT_T> (*i) + carry;
-        out.push_front(sum);
-        carry = (sum > integer::NEG1);
+    INTEGER_DIGIT_T carry = 0;
+    integer::REP_SIZE_T i = 0;
+
+    // add up matching digits
+    for(; i < rsize; i++){
+        const INTEGER_DOUBLE_DIGIT_T sum = static_cast <INTEGER_DOUBLE_DIGIT_T> (lhs[i]) + rhs[i] + carry;
+        lhs[i] = static_cast <INTEGER_DIGIT_T> (sum);
+        carry  = static_cast <INTEGER_DIGIT_T> (sum >> integer::BITS);
     }
 
-    // copy in rhs extra digits
-    for(; j != rhs._value.rend(); j++){
-        sum = static_cast <INTEGER_DOUBLE_DIGIT_T> (*j) + carry;
-        out.push_front(sum);
-        carry = (sum > integer::NEG1);
+    // carry into lhs extra digits
+    for(; carry && (i < lhs.size()); i++){
+        lhs[i] += carry;
+        carry = !lhs[i];
     }
 
+    // only grow when the sum needs another digit
     if (carry){
-        out.push_front(1);
+        lhs.push_back(carry);
     }
-    return integer(out);
 }
 
 integer integer::operator+(const integer & rhs) const {
-    if (!rhs){
-        return *this;
-    }
+    integer out(*this);
+    out += rhs;
+    return out;
+}
 
-    if (!*this){
-        return rhs;
+integer & integer::add_signed(const INTEGER_DIGIT_T * rhs, const integer::REP_SIZE_T & rsize, const integer::Sign & rsign){
+    if (_sign == rsign){                                                // same sign: lhs + rhs
+        add(_value, rhs, rsize);
     }
-
-    integer out = *this;
-    if (gt(out, rhs)){              // lhs > rhs
-        if (_sign == rhs._sign){    // same sign: lhs + rhs
-            out = add(out, rhs);
-        }
-        else{                       // different signs: lhs - rhs
-            out = sub(out, rhs);
-        }
-        out._sign = _sign;          // lhs sign dominates
+    else if (compare(_value.data(), _value.size(), rhs, rsize) >= 0){   // different signs and lhs >= rhs: lhs - rhs, lhs sign dominates
+        long_sub(_value, rhs, rsize);
     }
-    else if (lt(out, rhs)){         // lhs < rhs
-        if (_sign == rhs._sign){    // same sign: rhs + lhs
-            out = add(rhs, out);
-        }
-        else{                       // different sign: rhs - lhs
-            out = sub(rhs, out);
-        }
-        out._sign = rhs._sign;      // rhs sign dominates
+    else{                                                               // different signs and lhs < rhs: rhs - lhs, rhs sign dominates
+        long_rsub(_value, rhs, rsize);
+        _sign = rsign;
     }
-    else{                           // lhs == rhs
-        if (_sign == rhs._sign){    // same sign: double value
-            out <<= 1;
-            out._sign = _sign;
-        }
-        else{                       // different signs: 0
-            return 0;
-        }
-    }
-    out.trim();
-    return out;
+    return trim();
 }
 
 integer & integer::operator+=(const integer & rhs){
-    return *this = *this + rhs;
+    return add_signed(rhs._value.data(), rhs._value.size(), rhs._sign);
 }
 
 // Subtraction as done by hand
-integer integer::long_sub(const integer & lhs, const integer & rhs) const {
+void integer::long_sub(integer::REP & lhs, const INTEGER_DIGIT_T * rhs, const integer::REP_SIZE_T & rsize){
     // rhs always smaller than lhs
-    integer out = lhs;
-    integer::REP_SIZE_T lsize = out._value.size() - 1;
-    integer::REP_SIZE_T rsize = rhs._value.size() - 1;
-
-    for(integer::REP_SIZE_T x = 0; x <= rsize; x++){
-        // if top is bigger than or equal to the bottom, just substract
-        if (out._value[lsize - x] >= rhs._value[rsize - x]){
-            out._value[lsize - x] -= rhs._value[rsize - x];
-        }
-        else{// find a higher digit to carry from
-            integer::REP_SIZE_T y = lsize - x - 1;
-            // if this goes out of bounds, something is wrong
-            while (!out._value[y]){
-                y--;
-            }
-
-            out._value[y]--;
-            y++;
+    bool borrow = false;
+    integer::REP_SIZE_T i = 0;
+
+    for(; i < rsize; i++){
+        const INTEGER_DIGIT_T top    = lhs[i];
+        const INTEGER_DIGIT_T bottom = rhs[i];
+        lhs[i] = top - bottom - borrow;
+        borrow = (top < bottom) || ((top == bottom) && borrow);
+    }
 
-            for(; y < lsize - x; y++){
-                out._value[y] = integer::NEG1;
-            }
+    // borrow from lhs extra digits
+    for(; borrow && (i < lhs.size()); i++){
+        borrow = !lhs[i];
+        lhs[i]--;
+    }
+}
 
-            out._value[y] = static_cast <INTEGER_DOUBLE_DIGIT_T> (out._value[y]) + (static_cast <uint64_t> (1) << integer::BITS) - rhs._value[rsize - x];
-        }
+void integer::long_rsub(integer::REP & lhs, const INTEGER_DIGIT_T * rhs, const integer::REP_SIZE_T & rsize){
+    // lhs always smaller than rhs, so rhs does not point into lhs
+    const integer::REP_SIZE_T lsize = lhs.size();
+    lhs.resize(rsize, 0);
+
+    bool borrow = false;
+    for(integer::REP_SIZE_T i = 0; i < rsize; i++){
+        const INTEGER_DIGIT_T top    = rhs[i];
+        const INTEGER_DIGIT_T bottom = (i < lsize)?lhs[i]:0;
+        lhs[i] = top - bottom - borrow;
+        borrow = (top < bottom) || ((top == bottom) && borrow);
     }
-    return out;
 }
 
 //// Two's Complement Subtraction
@@ -638,70 +1053,14 @@ integer integer::long_sub(const integer & lhs, const integer & rhs) const {
 //    return add(lhs, rhs) & (~(integer(1) << lhs.bits()));   // Flip bits to get max of 1 << x
 //}
 
-// subtraction not considering signs
-// lhs must be larger than rhs
-integer integer::sub(const integer & lhs, const integer & rhs) const {
-    if (!rhs){
-        return lhs;
-    }
-    if (!lhs){
-        return -rhs;
-    }
-    if (lhs == rhs){
-        return 0;
-    }
-    return long_sub(lhs, rhs);
-    // return two_comp_sub(lhs, rhs);
-}
-
 integer integer::operator-(const integer & rhs) const {
-    integer out = *this;
-    if (gt(out, rhs)){                                  // if lhs > rhs
-        if (out._sign == rhs._sign){                    // same signs
-            out = sub(out, rhs);
-        }
-        else if (out._sign != rhs._sign){               // different signs
-            out = add(out, rhs);
-        }
-        out._sign = _sign;                              // lhs sign dominates
-    }
-    else if (lt(out, rhs)){                             // if lhs < rhs
-        if      (    (_sign == integer::NEGATIVE) &&    // - - -
-                 (rhs._sign == integer::NEGATIVE)){
-            out = sub(rhs, out);
-            out._sign = integer::POSITIVE;
-        }
-        else if (    (_sign == integer::NEGATIVE) &&    // - - +
-                 (rhs._sign == integer::POSITIVE)){
-            out = add(rhs, out);
-            out._sign = integer::NEGATIVE;
-        }
-        else if (    (_sign == integer::POSITIVE) &&    // + - -
-                 (rhs._sign == integer::NEGATIVE)){
-            out = add(out, rhs);
-            out._sign = integer::POSITIVE;
-        }
-        else if (    (_sign == integer::POSITIVE) &&    // + - +
-                 (rhs._sign == integer::POSITIVE)){
-            out = sub(rhs, out);
-            out._sign = integer::NEGATIVE;
-        }
-    }
-    else{                                               // if lhs == rhs
-        if (_sign == rhs._sign){                        // same signs: 0
-            return 0;
-        }
-        else{                                           // different signs: double value
-            out <<= 1;
-            out._sign = _sign;
-        }
-    }
-    out.trim();
+    integer out(*this);
+    out -= rhs;
     return out;
 }
 
 integer & integer::operator-=(const integer & rhs){
-    return *this = *this - rhs;
+    return add_signed(rhs._value.data(), rhs._value.size(), !rhs._sign);
 }
 
 // // Peasant Multiplication
@@ -740,232 +1099,758 @@ integer & integer::operator-=(const integer & rhs){
    // return add(lhs, z << 1);
 // }
 
-// // Karatsuba Algorithm
-// integer integer::karatsuba(const integer & lhs, const integer & rhs, integer bm) const {
-  // // b is integer::REP = 256
-  // // m is chars = 4
-  // // bm is max _value = b ^ m
-
-  // if ((lhs <= bm) | (rhs <= bm))
-      // return peasant(lhs, rhs);
-
-  // std::pair <integer, integer> x = dm(lhs, bm);
-  // std::pair <integer, integer> y = dm(rhs, bm);
-  // integer x0 = x.second;
-  // integer x1 = x.first;
-  // integer y0 = y.second;
-  // integer y1 = y.first;
-
-  // integer z0 = karatsuba(x0, y0);
-  // integer z2 = karatsuba(x1, y1);
-  // integer z1 = sub(sub(karatsuba(add(x1, x0), add(y1, y0)), z2), z0);
-  // return add(karatsuba(add(karatsuba(z2, bm), z1), bm), z0);
-// }
+INTEGER_DIGIT_T integer::add(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * lhs, const integer::REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const integer::REP_SIZE_T & rsize){
+    INTEGER_DIGIT_T carry = 0;
+    integer::REP_SIZE_T i = 0;
+    for(; i < rsize; i++){
+        const INTEGER_DOUBLE_DIGIT_T sum = static_cast <INTEGER_DOUBLE_DIGIT_T> (lhs[i]) + rhs[i] + carry;
+        out[i] = static_cast <INTEGER_DIGIT_T> (sum);
+        carry  = static_cast <INTEGER_DIGIT_T> (sum >> integer::BITS);
+    }
+    for(; i < lsize; i++){
+        out[i] = lhs[i] + carry;
+        carry  = carry && !out[i];
+    }
+    return carry;
+}
 
-// // Toom-Cook multiplication
-// // as described at http://en.wikipedia.org/wiki/Toom%E2%80%93Cook_multiplications
-// // This implementation is a bit weird. In the pointwise Multiplcation step, using
-// // operator* and long_mult works, but everything else fails.
-// // It's also kind of slow.
-// integer integer::toom_cook_3(integer m, integer n, integer bm){
-  // if ((m <= bm) | (n <= bm)){
-      // return peasant(m, n);
-   // }
+INTEGER_DIGIT_T integer::sub(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * lhs, const integer::REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const integer::REP_SIZE_T & rsize){
+    bool borrow = false;
+    integer::REP_SIZE_T i = 0;
+    for(; i < rsize; i++){
+        const INTEGER_DIGIT_T top    = lhs[i];
+        const INTEGER_DIGIT_T bottom = rhs[i];
+        out[i] = top - bottom - borrow;
+        borrow = (top < bottom) || ((top == bottom) && borrow);
+    }
+    for(; i < lsize; i++){
+        const INTEGER_DIGIT_T top = lhs[i];
+        out[i] = top - borrow;
+        borrow = borrow && !top;
+    }
+    return borrow;
+}
 
-  // // Splitting
-  // integer i = integer(std::max(m.log(3), n.log(3))) / 3 + 1;
-  // integer bi = pow(integer(3), i);
-  // integer B = 1;
-  // integer integer::REP = 10;
-  // while (B < bi){
-      // B *= integer::REP;
-   // }
+// Long multiplication
+void integer::long_mult(INTEGER_DIGIT_T * lhs, const integer::REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const integer::REP_SIZE_T & rsize){
+    std::fill(lhs + lsize, lhs + lsize + rsize, 0);
+
+    // each lhs digit is replaced by its row of the product. rows of
+    // higher digits only land on or above their own digit, so the
+    // lower digits are still intact when they are reached
+    for(integer::REP_SIZE_T i = lsize; i > 0; i--){
+        const INTEGER_DIGIT_T d = lhs[i - 1];
+        lhs[i - 1] = 0;
+
+        INTEGER_DIGIT_T carry = 0;
+        for(integer::REP_SIZE_T j = 0; j < rsize; j++){
+            const INTEGER_DOUBLE_DIGIT_T prod = static_cast <INTEGER_DOUBLE_DIGIT_T> (d) * rhs[j] + lhs[i - 1 + j] + carry;
+            lhs[i - 1 + j] = static_cast <INTEGER_DIGIT_T> (prod);
+            carry          = static_cast <INTEGER_DIGIT_T> (prod >> integer::BITS);
+        }
 
-  // integer M[3], N[3];
-  // for(uint8_t i = 0; i < 3; i++){
-      // std::pair <integer, integer> tm = dm(m, B);
-      // std::pair <integer, integer> tn = dm(n, B);
-      // m = tm.first;
-      // n = tn.first;
-      // M[i] = tm.second;
-      // N[i] = tn.second;
-  // }
-
-  // // Evaluation
-  // //             {0,             1,                 -1,                         -2,                             inf}
-  // integer p[5] = {M[0], M[0] + M[1] + M[2], M[0] - M[1] + M[2], M[0] - M[1] - M[1] + M[2] + M[2] + M[2] + M[2], M[2]};
-  // integer q[5] = {N[0], N[0] + N[1] + N[2], N[0] - N[1] + N[2], N[0] - N[1] - N[1] + N[2] + N[2] + N[2] + N[2], N[2]};
-
-  // // Pointwise Multiplication
-  // integer r[5];
-  // for(uint8_t i = 0; i < 5; i++)
-      // r[i] = p[i] * q[i];                 // don't understand why only integer::operator* and long_mult can be used here
-
-  // // Interpolation
-  // integer r0 = r[0];
-  // integer r4 = r[4];
-  // integer r3 = (r[3] - r[1]) / 3;
-  // integer r1 = (r[1] - r[2]) / 2;
-  // integer r2 = r[2] - r[0];
-  // r3 = (r2 - r3) / 2 + r4 + r4;
-  // r2 = r2 + r1 - r4;
-  // r1 = r1 - r3;
-
-  // // Recomposition
-  // return peasant(peasant(peasant(peasant(r4, B) + r3, B) + r2, B) + r1, B) + r0;
-// }
+        for(integer::REP_SIZE_T k = i - 1 + rsize; carry; k++){
+            const INTEGER_DOUBLE_DIGIT_T sum = static_cast <INTEGER_DOUBLE_DIGIT_T> (lhs[k]) + carry;
+            lhs[k] = static_cast <INTEGER_DIGIT_T> (sum);
+            carry  = static_cast <INTEGER_DIGIT_T> (sum >> integer::BITS);
+        }
+    }
+}
 
-// // Long multiplication
-// integer integer::long_mult(const integer & lhs, const integer & rhs) const {
-   // unsigned int zeros = 0;
-   // integer row, out = 0;
-   // for(integer::REP::const_reverse_iterator i = lhs._value.rbegin(); i != lhs._value.rend(); i++){
-       // row._value = integer::REP(zeros++, 0); // zeros on the right hand side
-       // INTEGER_DIGIT_T carry = 0;
-       // for(integer::REP::const_reverse_iterator j = rhs._value.rbegin(); j != rhs._value.rend(); j++){
-           // INTEGER_DOUBLE_DIGIT_T prod = (INTEGER_DOUBLE_DIGIT_T) *i * (INTEGER_DOUBLE_DIGIT_T) *j + carry;// multiply through
-           // row._value.push_front(prod & integer::NEG1);
-           // carry = prod >> integer::BITS;
-       // }
-       // if (carry){
-           // row._value.push_front(carry);
-       // }
-       // out = add(out, row);
-   // }
-   // return out;
-// }
+void integer::long_mult_low(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * lhs, const integer::REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const integer::REP_SIZE_T & rsize, const integer::REP_SIZE_T & size){
+    std::fill(out, out + size, 0);
 
-//Private FFT helper function
-int integer::fft(std::deque<double>& data, bool dir) const
-{
-     //Verify size is a power of two
-     std::size_t n = data.size()/2;
-     if ((n == 0) || (n & (n-1))) return 1;
-
-     //rearrange data for signal flow chart
-     std::size_t bitr_j = 1;
-     for (std::size_t i = 3; i < 2*n-1; i += 2)
-     {
-          std::size_t msz = n;
-          while (bitr_j >= msz)
-          {
-               bitr_j -= msz;
-               msz >>= 1;
-          }
-          bitr_j += msz;
-
-          if (bitr_j > i)
-          {
-               double swap = data[bitr_j-1];
-               data[bitr_j-1] = data[i-1];
-               data[i-1] = swap;
-               swap = data[bitr_j];
-               data[bitr_j] = data[i];
-               data[i] = swap;
-          }
-     }
-
-     //Perform "butterfly" calculations
-     std::size_t lmax = 2;
-     while (lmax <= n)
-     {
-          double wr = 1;
-          double wi = 0;
-
-          double theta = (2*M_PI)/double(lmax*(dir?1.0:-1.0));
-          double wpr = cos(theta);
-          double wpi = sin(theta);
-
-          int pstep = 2*lmax;
-          for (std::size_t l = 1; l < lmax; l += 2)
-          {
-               for (std::size_t p = l; p < 2*n; p += pstep)
-               {
-                    std::size_t q = p + lmax;
-                    double tempr = wr*data[q-1] - wi*data[q];
-                    double tempi = wr*data[q] + wi*data[q-1];
-                    data[q-1] = data[p-1] - tempr;
-                    data[q] = data[p] - tempi;
-                    data[p-1] = data[p-1] + tempr;
-                    data[p] = data[p] + tempi;
-               }
-
-               //Find the next power of W
-               double wtemp = wr;
-               wr = wr*wpr - wi*wpi;
-               wi = wi*wpr + wtemp*wpi;
-          }
-
-          lmax = pstep;
-     }
-
-     //All is good
-     return 0;
-}
-
-// FFT-based multiplication
-//Based on the convolution theorem which states that the Fourier
-//transform of a convolution is the pointwise product of their
-//Fourier transforms.
-integer integer::fft_mult(const integer& lhs, const integer& rhs) const {
-     //Convert each integer to input wanted by fft()
-     size_t size = 1;
-     while (size < lhs._value.size()*2){
-          size <<= 1;
-     }
-     while (size < rhs._value.size()*2){
-          size <<= 1;
-     }
-
-     std::deque<double> lhs_fft;
-     lhs_fft.resize(size*2, 0);
-     for (size_t i = 0; i < lhs._value.size(); i++){
-          lhs_fft[i*2] = double(lhs._value[lhs._value.size()-1-i]);
-     }
-
-     std::deque<double> rhs_fft;
-     rhs_fft.resize(size*2, 0);
-     for (size_t i = 0; i < rhs._value.size(); i++){
-          rhs_fft[i*2] = double(rhs._value[rhs._value.size()-1-i]);
-     }
-
-     //Compute the FFT of each
-     fft(lhs_fft);
-     fft(rhs_fft);
-
-     //Perform pointwise multiplication (numbers are complex)
-     std::deque<double> out_fft(2*size);
-     for (size_t i = 0; i < 2*size; i+=2){
-          out_fft[i] = lhs_fft[i]*rhs_fft[i] - lhs_fft[i+1]*rhs_fft[i+1];
-          out_fft[i+1] = lhs_fft[i]*rhs_fft[i+1] + lhs_fft[i+1]*rhs_fft[i];
-     }
-
-     //Compute the inverse FFT of this number
-     //remember to properly scale afterwards!
-     fft(out_fft, false);
-     for (size_t i = 0; i < 2*size; i++){
-          out_fft[i] /= size;
-     }
-
-     //Convert back to integer, carrying along the way
-     double carry = 0;
-     integer out;
-     for (size_t i = 0; i < 2*size; i+=2){
-          double current = out_fft[i]+carry;
-          if (current > double(integer::NEG1)){
-               carry = current / (double(integer::NEG1)+1);
-               carry = double(floor(carry+0.0001));
-               current = current - (carry*(integer::NEG1+1));
-
-          }
-          else {
-               carry = 0;
-          }
-          out._value.push_front(INTEGER_DIGIT_T(current+0.0001));
-     }
-
-     //Finish up
-     return out;
+    // every row stops at the top of the output
+    for(integer::REP_SIZE_T i = 0; i < std::min(lsize, size); i++){
+        const INTEGER_DIGIT_T d = lhs[i];
+        const integer::REP_SIZE_T end = std::min(rsize, size - i);
+
+        INTEGER_DIGIT_T carry = 0;
+        for(integer::REP_SIZE_T j = 0; j < end; j++){
+            const INTEGER_DOUBLE_DIGIT_T prod = static_cast <INTEGER_DOUBLE_DIGIT_T> (d) * rhs[j] + out[i + j] + carry;
+            out[i + j] = static_cast <INTEGER_DIGIT_T> (prod);
+            carry      = static_cast <INTEGER_DIGIT_T> (prod >> integer::BITS);
+        }
+
+        for(integer::REP_SIZE_T k = i + end; carry && (k < size); k++){
+            const INTEGER_DOUBLE_DIGIT_T sum = static_cast <INTEGER_DOUBLE_DIGIT_T> (out[k]) + carry;
+            out[k] = static_cast <INTEGER_DIGIT_T> (sum);
+            carry  = static_cast <INTEGER_DIGIT_T> (sum >> integer::BITS);
+        }
+    }
+}
+
+// Long squaring
+// Every product of two different digits appears twice in the square,
+// so each one is only calculated once and then doubled.
+void integer::long_sqr(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * value, const integer::REP_SIZE_T & size){
+    std::fill(out, out + 2 * size, 0);
+
+    // products of different digits
+    for(integer::REP_SIZE_T i = 0; i < size; i++){
+        INTEGER_DIGIT_T carry = 0;
+        for(integer::REP_SIZE_T j = i + 1; j < size; j++){
+            const INTEGER_DOUBLE_DIGIT_T prod = static_cast <INTEGER_DOUBLE_DIGIT_T> (value[i]) * value[j] + out[i + j] + carry;
+            out[i + j] = static_cast <INTEGER_DIGIT_T> (prod);
+            carry      = static_cast <INTEGER_DIGIT_T> (prod >> integer::BITS);
+        }
+        out[i + size] = carry;
+    }
+
+    // double them
+    INTEGER_DIGIT_T high = 0;
+    for(integer::REP_SIZE_T i = 0; i < 2 * size; i++){
+        const INTEGER_DIGIT_T d = out[i];
+        out[i] = (d << 1) | high;
+        high   = d >> (integer::BITS - 1);
+    }
+
+    // add the squares of each digit
+    INTEGER_DIGIT_T carry = 0;
+    for(integer::REP_SIZE_T i = 0; i < size; i++){
+        const INTEGER_DOUBLE_DIGIT_T sq = static_cast <INTEGER_DOUBLE_DIGIT_T> (value[i]) * value[i];
+
+        INTEGER_DOUBLE_DIGIT_T sum = static_cast <INTEGER_DOUBLE_DIGIT_T> (out[2 * i]) + static_cast <INTEGER_DIGIT_T> (sq) + carry;
+        out[2 * i] = static_cast <INTEGER_DIGIT_T> (sum);
+        carry      = static_cast <INTEGER_DIGIT_T> (sum >> integer::BITS);
+
+        sum = static_cast <INTEGER_DOUBLE_DIGIT_T> (out[2 * i + 1]) + static_cast <INTEGER_DIGIT_T> (sq >> integer::BITS) + carry;
+        out[2 * i + 1] = static_cast <INTEGER_DIGIT_T> (sum);
+        carry          = static_cast <INTEGER_DIGIT_T> (sum >> integer::BITS);
+    }
+}
+
+// Karatsuba multiplication
+// lhs = a1 * B^m + a0 and rhs = b1 * B^m + b0, so
+// lhs * rhs = a1b1 * B^2m + ((a0 + a1)(b0 + b1) - a1b1 - a0b0) * B^m + a0b0
+void integer::karatsuba(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * lhs, const integer::REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const integer::REP_SIZE_T & rsize){
+    const integer::REP_SIZE_T size = lsize + rsize;
+    const integer::REP_SIZE_T m    = lsize / 2;     // rsize > lsize / 2, so both halves of rhs are non-empty
+    const integer::REP_SIZE_T a1   = lsize - m;     // size of the top half of lhs (>= m)
+    const integer::REP_SIZE_T b1   = rsize - m;     // size of the top half of rhs
+
+    // a0b0 and a1b1 go directly into their places in out
+    // (when lhs is rhs, these are squares)
+    mult(out,         lhs,     m,  rhs,     m);
+    mult(out + 2 * m, lhs + m, a1, rhs + m, b1);
+
+    // (a0 + a1) and (b0 + b1), each with room for a carry
+    const bool square = (lhs == rhs) && (lsize == rsize);
+    const integer::REP_SIZE_T ssize = a1 + 1;
+    const integer::REP_SIZE_T tsize = std::max(m, b1) + 1;
+    scratch_buffer <INTEGER_DIGIT_T> scratch(2 * (ssize + tsize));
+    INTEGER_DIGIT_T * s    = scratch.data();
+    INTEGER_DIGIT_T * t    = s + ssize;
+    INTEGER_DIGIT_T * prod = t + tsize;
+
+    s[a1] = add(s, lhs + m, a1, lhs, m);
+    if (square){
+        t = s;                          // (a0 + a1)^2 is also a square
+    }
+    else if (b1 >= m){
+        t[b1] = add(t, rhs + m, b1, rhs, m);
+    }
+    else{
+        t[m] = add(t, rhs, m, rhs + m, b1);
+    }
+
+    // (a0 + a1)(b0 + b1) - a0b0 - a1b1
+    mult(prod, s, ssize, t, tsize);
+    sub(prod, prod, ssize + tsize, out,         2 * m);
+    sub(prod, prod, ssize + tsize, out + 2 * m, size - 2 * m);
+
+    // the middle term is less than B^(size - m), so its top digits are 0
+    add(out + m, out + m, size - m, prod, std::min(ssize + tsize, size - m));
+}
+
+integer integer::slice(const INTEGER_DIGIT_T * digits, const integer::REP_SIZE_T & size, const integer::REP_SIZE_T & first, const integer::REP_SIZE_T & count){
+    if (first >= size){
+        return integer();
+    }
+    return integer(integer::REP(digits + first, digits + std::min(size, first + count)));
+}
+
+void integer::recompose(INTEGER_DIGIT_T * out, const integer::REP_SIZE_T & size, const integer_span * coeffs, const integer::REP_SIZE_T & count, const integer::REP_SIZE_T & m){
+    std::fill(out, out + size, 0);
+
+    // each coefficient is at most the product shifted down by its
+    // position, so it always fits in the digits above that position
+    for(integer::REP_SIZE_T i = 0; i < count; i++){
+        const integer::REP_SIZE_T at = i * m;
+        if (coeffs[i].digits()){
+            add(out + at, out + at, size - at, coeffs[i].data(), coeffs[i].digits());
+        }
+    }
+}
+
+integer_span integer::mul_digit(const integer_span & value, const INTEGER_DIGIT_T & rhs){
+    INTEGER_DIGIT_T * digits = value.data();
+    integer::REP_SIZE_T size = value.digits();
+
+    INTEGER_DIGIT_T carry = 0;
+    for(integer::REP_SIZE_T i = 0; i < size; i++){
+        const INTEGER_DOUBLE_DIGIT_T prod = static_cast <INTEGER_DOUBLE_DIGIT_T> (digits[i]) * rhs + carry;
+        digits[i] = static_cast <INTEGER_DIGIT_T> (prod);
+        carry     = static_cast <INTEGER_DIGIT_T> (prod >> integer::BITS);
+    }
+    if (carry){
+        digits[size++] = carry;
+    }
+
+    return integer_span(digits, size, value.sign());
+}
+
+integer_span integer::div_exact(const integer_span & value, const INTEGER_DIGIT_T & rhs){
+    INTEGER_DIGIT_T * digits = value.data();
+    integer::REP_SIZE_T size = value.digits();
+
+    div_digit(digits, digits, size, rhs);
+    while (size && !digits[size - 1]){
+        size--;
+    }
+
+    return integer_span(digits, size, size?value.sign():integer::POSITIVE);
+}
+
+integer_span integer::shift_right(const integer_span & value, const unsigned int & bits){
+    INTEGER_DIGIT_T * digits = value.data();
+    integer::REP_SIZE_T size = value.digits();
+
+    for(integer::REP_SIZE_T i = 0; i < size; i++){
+        digits[i] = (digits[i] >> bits) | (((i + 1) < size)?static_cast <INTEGER_DIGIT_T> (digits[i + 1] << (integer::BITS - bits)):0);
+    }
+    while (size && !digits[size - 1]){
+        size--;
+    }
+
+    return integer_span(digits, size, size?value.sign():integer::POSITIVE);
+}
+
+namespace {
+
+// digits [first, first + count) of a digit array, without copying them
+integer_view piece(const INTEGER_DIGIT_T * digits, const integer::REP_SIZE_T & size, const integer::REP_SIZE_T & first, const integer::REP_SIZE_T & count){
+    if (first >= size){
+        return integer_view();
+    }
+    return integer_view(digits + first, std::min(count, size - first));
+}
+
+}
+
+// Toom-3 evaluated at 0, 1, -1, -2, and infinity
+// using the interpolation sequence by Marco Bodrato
+void integer::toom_cook_3(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * lhs, const integer::REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const integer::REP_SIZE_T & rsize){
+    const integer::REP_SIZE_T m = (lsize + 2) / 3;
+
+    // squares only need to be split and evaluated once
+    const bool square = (lhs == rhs) && (lsize == rsize);
+    const INTEGER_DIGIT_T * values[2] = {lhs, rhs};
+    const integer::REP_SIZE_T sizes[2] = {lsize, rsize};
+
+    // every evaluation, product, and step of the interpolation
+    // fits in 2m + 4 digits, so each one gets a slot that size
+    const integer::REP_SIZE_T slot = 2 * m + 4;
+    scratch_buffer <INTEGER_DIGIT_T> scratch(11 * slot);
+    auto room = [&](const integer::REP_SIZE_T & i){
+        return integer_span(scratch.data() + i * slot, slot);
+    };
+
+    integer_view p[2][5];
+    for(integer::REP_SIZE_T k = 0; k < (square?1:2); k++){
+        // Splitting
+        const integer_view x0 = piece(values[k], sizes[k], 0,     m);
+        const integer_view x1 = piece(values[k], sizes[k], m,     m);
+        const integer_view x2 = piece(values[k], sizes[k], 2 * m, m);
+
+        // Evaluation
+        const integer_span x02 = ::add(room(3 * k), x0, x2);
+        p[k][0] = x0;
+        p[k][2] = ::sub(room(3 * k + 1), x02, x1);
+        p[k][1] = ::add(room(3 * k), x02, x1);
+
+        integer_span t = ::add(room(3 * k + 2), x2, x2);
+        t = ::sub(room(3 * k + 2), t, x1);
+        t = ::add(room(3 * k + 2), t, t);
+        p[k][3] = ::add(room(3 * k + 2), t, x0);
+        p[k][4] = x2;
+    }
+
+    // Pointwise Multiplication
+    // (when both sides are the same digits, mult squares)
+    const integer_view (& q)[5] = p[square?0:1];
+    integer_span r[5];
+    for(integer::REP_SIZE_T i = 0; i < 5; i++){
+        r[i] = ::mult(room(6 + i), p[0][i], q[i]);
+    }
+
+    // Interpolation
+    // Each coefficient replaces a product in its slot:
+    // c0 = r0 and c4 = r4 already
+    r[3] = div_exact(::sub(room(9), r[3], r[1]), 3);       // c3 = (r3 - r1) / 3
+    r[1] = shift_right(::sub(room(7), r[1], r[2]), 1);     // c1 = (r1 - r2) / 2
+    r[2] = ::sub(room(8), r[2], r[0]);                     // c2 = r2 - r0
+    r[3] = shift_right(::sub(room(9), r[2], r[3]), 1);     // c3 = (c2 - c3) / 2 + 2r4
+    r[3] = ::add(room(9), r[3], r[4]);
+    r[3] = ::add(room(9), r[3], r[4]);
+    r[2] = ::add(room(8), r[2], r[1]);                     // c2 += c1 - r4
+    r[2] = ::sub(room(8), r[2], r[4]);
+    r[1] = ::sub(room(7), r[1], r[3]);                     // c1 -= c3
+
+    // Recomposition
+    recompose(out, lsize + rsize, r, 5, m);
+}
+
+// Toom-4 evaluated at 0, 1, -1, 2, -2, 3, and infinity
+// The even and odd coefficients are separated using the pairs of
+// opposite points, and the value at 3 supplies the last odd equation.
+void integer::toom_cook_4(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * lhs, const integer::REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const integer::REP_SIZE_T & rsize){
+    const integer::REP_SIZE_T m = (lsize + 3) / 4;
+
+    // squares only need to be split and evaluated once
+    const bool square = (lhs == rhs) && (lsize == rsize);
+    const INTEGER_DIGIT_T * values[2] = {lhs, rhs};
+    const integer::REP_SIZE_T sizes[2] = {lsize, rsize};
+
+    // every evaluation, product, and step of the interpolation
+    // fits in 2m + 4 digits, so each one gets a slot that size
+    const integer::REP_SIZE_T slot = 2 * m + 4;
+    scratch_buffer <INTEGER_DIGIT_T> scratch(17 * slot);
+    auto room = [&](const integer::REP_SIZE_T & i){
+        return integer_span(scratch.data() + i * slot, slot);
+    };
+
+    integer_view p[2][7];
+    for(integer::REP_SIZE_T k = 0; k < (square?1:2); k++){
+        // Splitting
+        integer_view x[4];
+        for(integer::REP_SIZE_T i = 0; i < 4; i++){
+            x[i] = piece(values[k], sizes[k], i * m, m);
+        }
+
+        // Evaluation
+        // even1 = x0 + x2, odd1 = x1 + x3, even2 = x0 + 4x2, and odd2 = 2x1 + 8x3
+        const integer::REP_SIZE_T s = 5 * k;
+        const integer_span even1 = ::add(room(s), x[0], x[2]);
+        const integer_span odd1  = ::add(room(s + 1), x[1], x[3]);
+        p[k][0] = x[0];
+        p[k][2] = ::sub(room(s + 2), even1, odd1);
+        p[k][1] = ::add(room(s), even1, odd1);
+
+        integer_span t = ::add(room(s + 3), x[2], x[2]);
+        t = ::add(room(s + 3), t, t);
+        const integer_span even2 = ::add(room(s + 1), t, x[0]);
+        t = ::add(room(s + 3), x[3], x[3]);
+        t = ::add(room(s + 3), t, t);
+        t = ::add(room(s + 3), t, x[1]);
+        const integer_span odd2 = ::add(room(s + 3), t, t);
+        p[k][4] = ::sub(room(s + 4), even2, odd2);
+        p[k][3] = ::add(room(s + 3), even2, odd2);
+
+        // ((3x3 + x2) * 3 + x1) * 3 + x0
+        t = ::add(room(s + 1), x[3], x[3]);
+        t = ::add(room(s + 1), t, x[3]);
+        t = mul_digit(::add(room(s + 1), t, x[2]), 3);
+        t = mul_digit(::add(room(s + 1), t, x[1]), 3);
+        p[k][5] = ::add(room(s + 1), t, x[0]);
+        p[k][6] = x[3];
+    }
+
+    // Pointwise Multiplication
+    // (when both sides are the same digits, mult squares)
+    const integer_view (& q)[7] = p[square?0:1];
+    integer_span r[7];
+    for(integer::REP_SIZE_T i = 0; i < 7; i++){
+        r[i] = ::mult(room(10 + i), p[0][i], q[i]);
+    }
+
+    // Interpolation
+    // The evaluations are no longer needed, so their slots hold
+    // e1 (and then c2) and a temporary value. Everything else
+    // replaces a product in its slot: c0 = r0 and c6 = r6 already.
+    const INTEGER_DIGIT_T NINE = 9, FIVE = 5;
+
+    // even coefficients: c2 + c4 and c2 + 4c4
+    integer_span e1 = shift_right(::add(room(0), r[1], r[2]), 1); // e1 = (r1 + r2) / 2 - r0 - r6
+    e1 = ::sub(room(0), e1, r[0]);
+    e1 = ::sub(room(0), e1, r[6]);
+    r[1] = shift_right(::sub(room(11), r[1], r[2]), 1);           // o1 = (r1 - r2) / 2
+    r[2] = shift_right(::add(room(12), r[3], r[4]), 1);           // e2 = ((r3 + r4) / 2 - r0 - 64r6) / 4
+    r[2] = ::sub(room(12), r[2], r[0]);
+    integer_span t = mul_digit(::add(room(1), r[6], r[6]), 32);
+    r[2] = shift_right(::sub(room(12), r[2], t), 2);
+    r[3] = shift_right(::sub(room(13), r[3], r[4]), 2);           // o2 = (r3 - r4) / 4
+    r[4] = div_exact(::sub(room(14), r[2], e1), 3);               // c4 = (e2 - e1) / 3
+    e1 = ::sub(room(0), e1, r[4]);                                // c2 = e1 - c4
+
+    // odd coefficients: c1 + c3 + c5, c1 + 4c3 + 16c5, and c1 + 9c3 + 81c5
+    t = ::mult(room(1), r[6], integer_view(&NINE, 1));            // o3 = (r5 - r0 - 9(c2 + 9(c4 + 9r6))) / 3
+    t = mul_digit(::add(room(1), t, r[4]), 9);
+    t = mul_digit(::add(room(1), t, e1), 9);
+    r[5] = ::sub(room(15), r[5], r[0]);
+    r[5] = div_exact(::sub(room(15), r[5], t), 3);
+    r[5] = div_exact(::sub(room(15), r[5], r[3]), 5);             // d2 = (o3 - o2) / 5 = c3 + 13c5
+    r[3] = div_exact(::sub(room(13), r[3], r[1]), 3);             // d1 = (o2 - o1) / 3 = c3 + 5c5
+    r[5] = shift_right(::sub(room(15), r[5], r[3]), 3);           // c5 = (d2 - d1) / 8
+    t = ::mult(room(1), r[5], integer_view(&FIVE, 1));            // c3 = d1 - 5c5
+    r[3] = ::sub(room(13), r[3], t);
+    r[1] = ::sub(room(11), r[1], r[3]);                           // c1 = o1 - c3 - c5
+    r[1] = ::sub(room(11), r[1], r[5]);
+    r[2] = e1;
+
+    // Recomposition
+    recompose(out, lsize + rsize, r, 7, m);
+}
+
+void integer::mult(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * lhs, const integer::REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const integer::REP_SIZE_T & rsize){
+    if (lsize < rsize){
+        mult(out, rhs, rsize, lhs, lsize);
+        return;
+    }
+
+    const integer::REP_SIZE_T bits = rsize * integer::BITS;
+
+    // splitting fewer than 4 digits does not make the pieces any smaller
+    if ((bits < karatsuba_threshold) || (rsize < 4)){
+        if ((lhs == rhs) && (lsize == rsize)){
+            long_sqr(out, lhs, lsize);
+        }
+        else{
+            std::copy(lhs, lhs + lsize, out);
+            long_mult(out, lsize, rhs, rsize);
+        }
+        return;
+    }
+
+    // very uneven values are multiplied one rsize sized piece of lhs at a time
+    if (lsize >= 2 * rsize){
+        std::fill(out, out + lsize + rsize, 0);
+        scratch_buffer <INTEGER_DIGIT_T> piece(2 * rsize);
+        for(integer::REP_SIZE_T i = 0; i < lsize; i += rsize){
+            const integer::REP_SIZE_T size = std::min(rsize, lsize - i);
+            mult(piece.data(), lhs + i, size, rhs, rsize);
+            add(out + i, out + i, lsize + rsize - i, piece.data(), size + rsize);
+        }
+        return;
+    }
+
+    if (bits < toom3_threshold){
+        karatsuba(out, lhs, lsize, rhs, rsize);
+    }
+    else if (bits < toom4_threshold){
+        toom_cook_3(out, lhs, lsize, rhs, rsize);
+    }
+    else if (bits < ntt_threshold){
+        toom_cook_4(out, lhs, lsize, rhs, rsize);
+    }
+    else{
+        ntt_mult(out, lhs, lsize, rhs, rsize);
+    }
+}
+
+integer integer::mult(const integer_view & lhs, const integer_view & rhs){
+    const integer::REP_SIZE_T lsize = lhs.digits();
+    const integer::REP_SIZE_T rsize = rhs.digits();
+
+    // products that might fit without allocating are built on the stack first
+    if ((lsize + rsize) <= (2 * integer::REP::inline_capacity)){
+        INTEGER_DIGIT_T small[2 * integer::REP::inline_capacity];
+        mult(small, lhs.data(), lsize, rhs.data(), rsize);
+
+        integer::REP_SIZE_T size = lsize + rsize;
+        while (size && !small[size - 1]){
+            size--;
+        }
+        return integer(integer::REP(small, small + size));
+    }
+
+    integer::REP out(lsize + rsize, 0);
+    mult(out.data(), lhs.data(), lsize, rhs.data(), rsize);
+    return integer(std::move(out));
+}
+
+integer & integer::mult_digit(const INTEGER_DIGIT_T & rhs, const integer::Sign & rsign){
+    if (!rhs){
+        return *this = 0;
+    }
+
+    INTEGER_DIGIT_T carry = 0;
+    for(INTEGER_DIGIT_T & d : _value){
+        const INTEGER_DOUBLE_DIGIT_T prod = static_cast <INTEGER_DOUBLE_DIGIT_T> (d) * rhs + carry;
+        d     = static_cast <INTEGER_DIGIT_T> (prod);
+        carry = static_cast <INTEGER_DIGIT_T> (prod >> integer::BITS);
+    }
+
+    // only grow when the product needs another digit
+    if (carry){
+        _value.push_back(carry);
+    }
+
+    _sign ^= rsign;
+    return trim();
+}
+
+namespace {
+
+// 64 bit words modulo a prime p < 2^62 for the NTT
+// Multiplication is done with Montgomery reduction, so the
+// twiddle factors are kept multiplied by R = 2^64 (mod p).
+class ntt_prime{
+    public:
+        // (hi, lo) = lhs * rhs
+        static void mult(const uint64_t & lhs, const uint64_t & rhs, uint64_t & hi, uint64_t & lo){
+            #if defined(__SIZEOF_INT128__)
+            const __uint128_t prod = static_cast <__uint128_t> (lhs) * rhs;
+            hi = static_cast <uint64_t> (prod >> 64);
+            lo = static_cast <uint64_t> (prod);
+            #else
+            const uint64_t ll = (lhs & 0xffffffffU) * (rhs & 0xffffffffU);
+            const uint64_t lh = (lhs & 0xffffffffU) * (rhs >> 32);
+            const uint64_t hl = (lhs >> 32) * (rhs & 0xffffffffU);
+            const uint64_t hh = (lhs >> 32) * (rhs >> 32);
+            const uint64_t mid = (ll >> 32) + (lh & 0xffffffffU) + (hl & 0xffffffffU);
+            hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+            lo = (mid << 32) | (ll & 0xffffffffU);
+            #endif
+        }
+
+        const uint64_t p;       // c * 2^k + 1
+        const uint64_t root;    // primitive root of p
+
+    private:
+        uint64_t neg_inv;       // -p^-1 mod 2^64
+        uint64_t r2;            // R^2 mod p
+
+    public:
+        ntt_prime(const uint64_t & prime, const uint64_t & primitive_root) :
+            p(prime),
+            root(primitive_root),
+            neg_inv(prime),
+            r2(0)
+        {
+            // Newton's method doubles the number of correct bits of p^-1 each time
+            for(int i = 0; i < 5; i++){
+                neg_inv *= 2 - p * neg_inv;
+            }
+            neg_inv = -neg_inv;
+
+            // R mod p, doubled 64 more times
+            r2 = ((static_cast <uint64_t> (-1) % p) + 1) % p;
+            for(int i = 0; i < 64; i++){
+                r2 = add(r2, r2);
+            }
+        }
+
+        uint64_t add(const uint64_t & lhs, const uint64_t & rhs) const {
+            const uint64_t sum = lhs + rhs;
+            return (sum >= p)?(sum - p):sum;
+        }
+
+        uint64_t sub(const uint64_t & lhs, const uint64_t & rhs) const {
+            return (lhs >= rhs)?(lhs - rhs):(lhs + p - rhs);
+        }
+
+        // lhs * rhs / R (mod p)
+        uint64_t mul(const uint64_t & lhs, const uint64_t & rhs) const {
+            uint64_t hi, lo, mhi, mlo;
+            mult(lhs, rhs, hi, lo);
+            mult(lo * neg_inv, p, mhi, mlo);
+            const uint64_t out = hi + mhi + (lo != 0);  // lo + mlo is either 0 or 2^64
+            return (out >= p)?(out - p):out;
+        }
+
+        // x * R (mod p)
+        uint64_t to(const uint64_t & x) const {
+            return mul(x % p, r2);
+        }
+
+        // base^exp * R (mod p), where base is already multiplied by R
+        uint64_t pow(uint64_t base, uint64_t exp) const {
+            uint64_t out = to(1);
+            while (exp){
+                if (exp & 1){
+                    out = mul(out, base);
+                }
+                base = mul(base, base);
+                exp >>= 1;
+            }
+            return out;
+        }
+
+        // base^-1 * R (mod p), where base is already multiplied by R
+        uint64_t inv(const uint64_t & base) const {
+            return pow(base, p - 2);
+        }
+
+        // In place transform of a power of 2 number of values. The inverse
+        // transform leaves the values multiplied by the size of the data.
+        void transform(uint64_t * data, const std::size_t & n, const bool & inverse) const {
+            // rearrange data for signal flow chart
+            for(std::size_t i = 1, j = 0; i < n; i++){
+                std::size_t bit = n >> 1;
+                for(; j & bit; bit >>= 1){
+                    j ^= bit;
+                }
+                j ^= bit;
+                if (i < j){
+                    std::swap(data[i], data[j]);
+                }
+            }
+
+            // powers of the n-th root of unity
+            uint64_t w = pow(to(root), (p - 1) / n);
+            if (inverse){
+                w = inv(w);
+            }
+            scratch_buffer <uint64_t> twiddle(std::max(n / 2, static_cast <std::size_t> (1)));
+            twiddle[0] = to(1);
+            for(std::size_t i = 1; i < twiddle.size(); i++){
+                twiddle[i] = mul(twiddle[i - 1], w);
+            }
+
+            // butterflies
+            for(std::size_t len = 2; len <= n; len <<= 1){
+                const std::size_t half   = len >> 1;
+                const std::size_t stride = n / len;
+                for(std::size_t i = 0; i < n; i += len){
+                    for(std::size_t j = 0; j < half; j++){
+                        const uint64_t u = data[i + j];
+                        const uint64_t v = mul(data[i + j + half], twiddle[j * stride]);
+                        data[i + j]        = add(u, v);
+                        data[i + j + half] = sub(u, v);
+                    }
+                }
+            }
+        }
+};
+
+// primes of the form c * 2^50 + 1 below 2^62, along with their smallest primitive roots
+// Their product is more than 2^185, so coefficients of products of up to 2^57 words fit.
+static const ntt_prime NTT_PRIMES[3] = {
+    ntt_prime(0x3fdc000000000001ULL, 3),
+    ntt_prime(0x3f18000000000001ULL, 10),
+    ntt_prime(0x3ec4000000000001ULL, 37),
+};
+
+}
+
+void integer::ntt_mult(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * lhs, const integer::REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const integer::REP_SIZE_T & rsize){
+    static_assert((64 % integer::BITS) == 0, "INTEGER_DIGIT_T must evenly divide 64 bits");
+    const std::size_t PER_WORD = 64 / integer::BITS;
+
+    // squares only need one forward transform per prime
+    const bool square = (lhs == rhs) && (lsize == rsize);
+
+    // repack the digits into 64 bit words
+    const std::size_t lwords = (lsize + PER_WORD - 1) / PER_WORD;
+    const std::size_t rwords = (rsize + PER_WORD - 1) / PER_WORD;
+    scratch_buffer <uint64_t> lhs64(lwords, 0), rhs64(square?0:rwords, 0);
+    for(integer::REP_SIZE_T i = 0; i < lsize; i++){
+        lhs64[i / PER_WORD] |= static_cast <uint64_t> (lhs[i]) << ((i % PER_WORD) * integer::BITS);
+    }
+    for(integer::REP_SIZE_T i = 0; (i < rsize) && !square; i++){
+        rhs64[i / PER_WORD] |= static_cast <uint64_t> (rhs[i]) << ((i % PER_WORD) * integer::BITS);
+    }
+
+    std::size_t n = 1;
+    while (n < (lwords + rwords - 1)){
+        n <<= 1;
+    }
+
+    // convolve modulo each prime
+    scratch_buffer <uint64_t> convolutions(3 * n);
+    const uint64_t * residues[3];
+    for(std::size_t k = 0; k < 3; k++){
+        const ntt_prime & prime = NTT_PRIMES[k];
+
+        uint64_t * a = convolutions.data() + k * n;
+        residues[k] = a;
+        std::fill(a, a + n, 0);
+        for(std::size_t i = 0; i < lwords; i++){
+            a[i] = lhs64[i] % prime.p;
+        }
+        prime.transform(a, n, false);
+
+        scratch_buffer <uint64_t> b(square?0:n, 0);
+        if (!square){
+            for(std::size_t i = 0; i < rwords; i++){
+                b[i] = rhs64[i] % prime.p;
+            }
+            prime.transform(b.data(), n, false);
+        }
+        const uint64_t * rhs_ntt = square?a:b.data();
+
+        // the pointwise products are divided by R, so multiplying
+        // by R^2 / n makes the inverse transform come out exact
+        const uint64_t scale = prime.to(prime.inv(prime.to(n)));
+        for(std::size_t i = 0; i < n; i++){
+            a[i] = prime.mul(prime.mul(a[i], rhs_ntt[i]), scale);
+        }
+
+        prime.transform(a, n, true);
+    }
+
+    // Garner's algorithm: x = x0 + p0 * (x1 + p1 * x2)
+    const ntt_prime & p0 = NTT_PRIMES[0];
+    const ntt_prime & p1 = NTT_PRIMES[1];
+    const ntt_prime & p2 = NTT_PRIMES[2];
+    const uint64_t inv01 = p1.inv(p1.to(p0.p));     // p0^-1 mod p1, times R
+    const uint64_t inv02 = p2.inv(p2.to(p0.p));     // p0^-1 mod p2, times R
+    const uint64_t inv12 = p2.inv(p2.to(p1.p));     // p1^-1 mod p2, times R
+    uint64_t p01_hi, p01_lo;
+    ntt_prime::mult(p0.p, p1.p, p01_hi, p01_lo);
+
+    // add up the coefficients, carrying up to 3 words along the way
+    const std::size_t words = lwords + rwords;
+    scratch_buffer <uint64_t> out64(words, 0);
+    uint64_t carry[3] = {0, 0, 0};
+    for(std::size_t i = 0; i < words; i++){
+        uint64_t x[3] = {0, 0, 0};
+        if (i < n){
+            const uint64_t r0 = residues[0][i];
+            const uint64_t x1 = p1.mul(p1.sub(residues[1][i], r0 % p1.p), inv01);
+            const uint64_t x2 = p2.mul(p2.sub(p2.mul(p2.sub(residues[2][i], r0 % p2.p), inv02), x1 % p2.p), inv12);
+
+            // x0 + p0 * x1
+            uint64_t hi, lo;
+            ntt_prime::mult(p0.p, x1, hi, lo);
+            x[0] = lo + r0;
+            x[1] = hi + (x[0] < lo);
+
+            // + p0 * p1 * x2, which is less than 2^186
+            ntt_prime::mult(p01_lo, x2, hi, lo);
+            x[0] += lo;
+            const uint64_t c0 = (x[0] < lo);
+            x[1] += c0;
+            uint64_t c1 = (x[1] < c0);
+            x[1] += hi;
+            c1 += (x[1] < hi);
+            x[2] += c1;
+
+            ntt_prime::mult(p01_hi, x2, hi, lo);
+            x[1] += lo;
+            x[2] += hi + (x[1] < lo);
+        }
+
+        // carry += x
+        uint64_t c = 0;
+        for(std::size_t j = 0; j < 3; j++){
+            const uint64_t sum = carry[j] + c;
+            c = (sum < c);
+            carry[j] = sum + x[j];
+            c += (carry[j] < x[j]);
+        }
+
+        out64[i] = carry[0];
+        carry[0] = carry[1];
+        carry[1] = carry[2];
+        carry[2] = 0;
+    }
+
+    // unpack the words into digits
+    for(integer::REP_SIZE_T i = 0; i < (lsize + rsize); i++){
+        out[i] = static_cast <INTEGER_DIGIT_T> (out64[i / PER_WORD] >> ((i % PER_WORD) * integer::BITS));
+    }
 }
 
 integer integer::operator*(const integer & rhs) const {
@@ -983,16 +1868,31 @@ integer integer::operator*(const integer & rhs) const {
     // integer out = peasant(*this, rhs);
     // integer out = recursive_peasant(*this, rhs);
     // integer out = recursive_mult(*this, rhs);
-    // integer out = karatsuba(*this, rhs);
-    // integer out = toom_cook_3(*this, rhs);
-    // integer out = long_mult(*this, rhs);
-    integer out = fft_mult(*this, rhs);
+    integer out = mult(*this, rhs);
     out._sign = _sign ^ rhs._sign;
     out.trim();
     return out;
 }
 
+integer integer::sqr() const {
+    return mult(*this, *this);
+}
+
 integer & integer::operator*=(const integer & rhs){
+    const integer::REP_SIZE_T lsize = _value.size();
+    const integer::REP_SIZE_T rsize = rhs._value.size();
+
+    // multiply by hand in place when the product already fits in the
+    // existing buffer, or when growing it could not have been avoided
+    if ((this != &rhs) && lsize && rsize &&
+        ((std::min(lsize, rsize) * integer::BITS) < karatsuba_threshold) &&
+        ((_value.capacity() >= (lsize + rsize)) || ((lsize + rsize) > (2 * integer::REP::inline_capacity)))){
+        _value.resize(lsize + rsize);
+        long_mult(_value.data(), lsize, rhs._value.data(), rsize);
+        _sign ^= rhs._sign;
+        return trim();
+    }
+
     return *this = *this * rhs;
 }
 
@@ -1006,29 +1906,6 @@ integer & integer::operator*=(const integer & rhs){
     // return qr;
 // }
 
-// // Long Division returning both quotient and remainder
-// std::pair <integer, integer> integer::long_divmod(const integer & lhs, const integer & rhs) const {
-   // std::pair <integer, integer> qr(0, lhs);
-   // integer copyd = rhs;
-   // integer adder = 1;
-   // integer shift = qr.second.bits() - copyd.bits();
-    // copyd <<= shift;
-    // adder <<= shift;
-   // // while (qr.second > copyd){
-       // // copyd <<= 1;
-       // // adder <<= 1;
-   // // }
-   // while (qr.second >= rhs){
-       // if (qr.second >= copyd){
-           // qr.second -= copyd;
-           // qr.first |= adder;
-       // }
-       // copyd >>= 1;
-       // adder >>= 1;
-   // }
-   // return qr;
-// }
-
 // // Recursive Division that returns both the quotient and remainder
 // // Recursion took up way too much memory
 // std::pair <integer, integer> integer::recursive_divmod(const integer & lhs, const integer & rhs) const {
@@ -1050,54 +1927,299 @@ integer & integer::operator*=(const integer & rhs){
    // return qr;
 // }
 
-// Non-Recursive version of above algorithm
-std::pair <integer, integer> integer::non_recursive_divmod(const integer & lhs, const integer & rhs) const {
-    std::pair <integer, integer> qr (0, 0);
-    for(integer::REP_SIZE_T x = lhs.bits(); x > 0; x--){
-        qr.first  <<= 1;
-        qr.second <<= 1;
-
-        if (lhs[x - 1]){
-            qr.second++;
+// Long division (Knuth's Algorithm D)
+void integer::long_div(INTEGER_DIGIT_T * q, INTEGER_DIGIT_T * u, const integer::REP_SIZE_T & usize, const INTEGER_DIGIT_T * v, const integer::REP_SIZE_T & vsize){
+    const INTEGER_DOUBLE_DIGIT_T BASE = static_cast <INTEGER_DOUBLE_DIGIT_T> (1) << integer::BITS;
+    const integer::REP_SIZE_T n = vsize;    // local copy so writes to u do not force reloads
+    const INTEGER_DIGIT_T v1 = v[n - 1];
+    const INTEGER_DIGIT_T v2 = v[n - 2];
+
+    for(integer::REP_SIZE_T j = usize - n + 1; j > 0; j--){
+        INTEGER_DIGIT_T * uj = u + j - 1;
+
+        // estimate the quotient digit from the top two digits of the remainder
+        // and the top digit of v. It is at most 2 too large, and the second
+        // digit of v catches almost every case where it is.
+        const INTEGER_DOUBLE_DIGIT_T top = (static_cast <INTEGER_DOUBLE_DIGIT_T> (uj[n]) << integer::BITS) | uj[n - 1];
+        INTEGER_DOUBLE_DIGIT_T qhat = top / v1;
+        INTEGER_DOUBLE_DIGIT_T rhat = top % v1;
+        while ((qhat >= BASE) || ((qhat * v2) > ((rhat << integer::BITS) | uj[n - 2]))){
+            qhat--;
+            rhat += v1;
+            if (rhat >= BASE){
+                break;
+            }
         }
+        INTEGER_DIGIT_T qd = static_cast <INTEGER_DIGIT_T> (qhat);
+
+        // uj -= qd * v
+        // the difference wraps around when it goes negative,
+        // so the borrow is the bottom bit of the top half
+        INTEGER_DIGIT_T carry  = 0;
+        INTEGER_DIGIT_T borrow = 0;
+        for(integer::REP_SIZE_T i = 0; i < n; i++){
+            const INTEGER_DOUBLE_DIGIT_T prod = static_cast <INTEGER_DOUBLE_DIGIT_T> (qd) * v[i] + carry;
+            carry = static_cast <INTEGER_DIGIT_T> (prod >> integer::BITS);
+
+            const INTEGER_DOUBLE_DIGIT_T diff = static_cast <INTEGER_DOUBLE_DIGIT_T> (uj[i]) - static_cast <INTEGER_DIGIT_T> (prod) - borrow;
+            uj[i] = static_cast <INTEGER_DIGIT_T> (diff);
+            borrow = static_cast <INTEGER_DIGIT_T> (diff >> integer::BITS) & 1;
+        }
+        const INTEGER_DOUBLE_DIGIT_T diff = static_cast <INTEGER_DOUBLE_DIGIT_T> (uj[n]) - carry - borrow;
+        uj[n] = static_cast <INTEGER_DIGIT_T> (diff);
 
-        if (qr.second >= rhs){
-            qr.second -= rhs;
-            qr.first++;
+        // the estimate was 1 too large, so add v back
+        if ((diff >> integer::BITS) & 1){
+            qd--;
+            uj[n] += add(uj, uj, n, v, n);
         }
+
+        q[j - 1] = qd;
     }
-    return qr;
 }
 
-// division and modulus ignoring signs
-std::pair <integer, integer> integer::dm(const integer & lhs, const integer & rhs) const {
-    if (!rhs){              // divide by 0 error
-        throw std::domain_error("Error: division or modulus by 0");
+INTEGER_DIGIT_T integer::shift_left(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * digits, const integer::REP_SIZE_T & size, const unsigned int & shift){
+    if (!shift){
+        if (out != digits){
+            std::copy(digits, digits + size, out);
+        }
+        return 0;
     }
 
-    if (rhs == 1){          // divide by 1 check
-        return {lhs, 0};
+    // from the top down, so that out can be digits
+    const INTEGER_DIGIT_T spill = digits[size - 1] >> (integer::BITS - shift);
+    for(integer::REP_SIZE_T i = size - 1; i > 0; i--){
+        out[i] = (digits[i] << shift) | (digits[i - 1] >> (integer::BITS - shift));
     }
-    if (lhs == rhs){        // divide by same value check
-        return {1, 0};
+    out[0] = digits[0] << shift;
+    return spill;
+}
+
+void integer::long_divmod(INTEGER_DIGIT_T * q, INTEGER_DIGIT_T * r, const integer_view & lhs, const integer_view & rhs){
+    const integer::REP_SIZE_T usize = lhs.digits();
+    const integer::REP_SIZE_T vsize = rhs.digits();
+    const INTEGER_DIGIT_T * ld = lhs.data();
+    const INTEGER_DIGIT_T * rd = rhs.data();
+
+    // shift both values left until the top bit of the divisor is set
+    // so that the quotient digit estimates are close
+    unsigned int shift = 0;
+    for(INTEGER_DIGIT_T top = rd[vsize - 1]; !(top & integer::HIGH_BIT); top <<= 1){
+        shift++;
     }
-    if (!lhs){              // 0 / rhs check
-        return {0, 0};
+
+    // the dividend becomes the remainder, so it is always copied,
+    // but a divisor that is already normalized is used where it is
+    scratch_buffer <INTEGER_DIGIT_T> u(usize + 1), v(shift?vsize:0);
+
+    // only add a digit to the dividend if the shift pushes bits out of the top
+    const INTEGER_DIGIT_T spill = shift_left(u.data(), ld, usize, shift);
+    u[usize] = spill;
+    if (shift){
+        shift_left(v.data(), rd, vsize, shift);
+        rd = v.data();
     }
-    if (lt(lhs, rhs)){      // lhs < rhs check
-        return {0, lhs};
+
+    std::fill(q, q + usize - vsize + 1, 0);
+    if (spill){
+        long_div(q, u.data(), usize, rd, vsize);
     }
+    else{
+        // the top vsize digits are less than 2v, so the top
+        // quotient digit is found with at most one subtraction
+        INTEGER_DIGIT_T * top = u.data() + usize - vsize;
+        if (compare(top, vsize, rd, vsize) >= 0){
+            sub(top, top, vsize, rd, vsize);
+            q[usize - vsize] = 1;
+        }
 
-    // return naive_divmod(lhs, rhs);
-    // return long_divmod(lhs, rhs);
-    // return recursive_divmod(lhs, rhs);
-    return non_recursive_divmod(lhs, rhs);
+        if (usize > vsize){
+            long_div(q, u.data(), usize - 1, rd, vsize);
+        }
+    }
+
+    // shift the remainder back
+    for(integer::REP_SIZE_T i = 0; i < vsize; i++){
+        r[i] = (u[i] >> shift) | ((shift && ((i + 1) < vsize))?(u[i + 1] << (integer::BITS - shift)):0);
+    }
+}
+
+std::pair <integer, integer> integer::long_divmod(const integer_view & lhs, const integer_view & rhs){
+    integer::REP q(lhs.digits() - rhs.digits() + 1), r(rhs.digits());
+    long_divmod(q.data(), r.data(), lhs, rhs);
+    return {integer(std::move(q)), integer(std::move(r))};
+}
+
+void integer::bz_div_2n_1n(INTEGER_DIGIT_T * q, INTEGER_DIGIT_T * a, const INTEGER_DIGIT_T * b, const integer::REP_SIZE_T & n){
+    // small divisors go back to long division
+    if (n < 2){
+        const INTEGER_DOUBLE_DIGIT_T top = (static_cast <INTEGER_DOUBLE_DIGIT_T> (a[1]) << integer::BITS) | a[0];
+        q[0] = static_cast <INTEGER_DIGIT_T> (top / b[0]);
+        a[0] = static_cast <INTEGER_DIGIT_T> (top % b[0]);
+        return;
+    }
+    if ((n * integer::BITS) < burnikel_ziegler_threshold){
+        long_div(q, a, 2 * n - 1, b, n);
+        return;
+    }
+
+    // the top half of the quotient comes from the top n + hi digits,
+    // which leaves a remainder that is the top of the next division.
+    // Odd sizes are split unevenly instead of padded.
+    const integer::REP_SIZE_T lo = n >> 1;
+    const integer::REP_SIZE_T hi = n - lo;
+    bz_div_3n_2n(q + lo, a + lo, hi, b, n);
+    bz_div_3n_2n(q,      a,      lo, b, n);
+}
+
+void integer::bz_div_3n_2n(INTEGER_DIGIT_T * q, INTEGER_DIGIT_T * a, const integer::REP_SIZE_T & k, const INTEGER_DIGIT_T * b, const integer::REP_SIZE_T & n){
+    // b = b1 * B^(n - k) + b2, where b1 has k digits
+    const INTEGER_DIGIT_T * b1 = b + n - k;
+    INTEGER_DIGIT_T * a12 = a + n - k;
+
+    // when the top digits are equal, the quotient estimate
+    // would be B^k, so it is capped at B^k - 1
+    INTEGER_DIGIT_T carry = 0;
+    if (compare(a12 + k, k, b1, k) == 0){
+        std::fill(q, q + k, integer::NEG1);
+        carry = add(a12, a12, k, b1, k);
+    }
+    else{
+        bz_div_2n_1n(q, a12, b1, k);
+    }
+
+    // the remainder of the estimate, followed by the rest of the digits of a,
+    // minus the estimate times b2. The estimate is at most 2 too large
+    // because b is normalized, so b is added back at most twice.
+    scratch_buffer <INTEGER_DIGIT_T> t(n);
+    mult(t.data(), q, k, b, n - k);
+    int top = static_cast <int> (carry) - static_cast <int> (sub(a, a, n, t.data(), n));
+    const INTEGER_DIGIT_T one = 1;
+    while (top < 0){
+        top += add(a, a, n, b, n);
+        sub(q, q, k, &one, 1);
+    }
+}
+
+void integer::burnikel_ziegler(INTEGER_DIGIT_T * q, INTEGER_DIGIT_T * r, const integer_view & lhs, const integer_view & rhs){
+    const integer::REP_SIZE_T usize = lhs.digits();
+    const integer::REP_SIZE_T n     = rhs.digits();
+    const INTEGER_DIGIT_T * ld = lhs.data();
+    const INTEGER_DIGIT_T * rd = rhs.data();
+
+    // shift both values left until the top bit of the divisor is set
+    unsigned int shift = 0;
+    for(INTEGER_DIGIT_T top = rd[n - 1]; !(top & integer::HIGH_BIT); top <<= 1){
+        shift++;
+    }
+
+    // the dividend is cut into n digit blocks with room for the bits shifted
+    // out of the top. The top block is always less than the divisor, since
+    // either it has fewer digits, or its top digit only holds those bits.
+    const integer::REP_SIZE_T blocks = usize / n + 1;
+    scratch_buffer <INTEGER_DIGIT_T> u(blocks * n, 0), v(shift?n:0), quotient((blocks - 1) * n);
+    u[usize] = shift_left(u.data(), ld, usize, shift);
+    if (shift){
+        shift_left(v.data(), rd, n, shift);
+        rd = v.data();
+    }
+
+    // divide each pair of blocks from the top down, which leaves
+    // the remainder in the lower block for the next pair
+    for(integer::REP_SIZE_T i = blocks - 1; i > 0; i--){
+        bz_div_2n_1n(quotient.data() + (i - 1) * n, u.data() + (i - 1) * n, rd, n);
+    }
+    std::copy(quotient.data(), quotient.data() + usize - n + 1, q);
+
+    // shift the remainder back
+    for(integer::REP_SIZE_T i = 0; i < n; i++){
+        r[i] = (u[i] >> shift) | ((shift && ((i + 1) < n))?(u[i + 1] << (integer::BITS - shift)):0);
+    }
+}
+
+std::pair <integer, integer> integer::burnikel_ziegler(const integer_view & lhs, const integer_view & rhs){
+    integer::REP q(lhs.digits() - rhs.digits() + 1), r(rhs.digits());
+    burnikel_ziegler(q.data(), r.data(), lhs, rhs);
+    return {integer(std::move(q)), integer(std::move(r))};
+}
+
+INTEGER_DIGIT_T integer::div_digit(const INTEGER_DIGIT_T & rhs, const integer::Sign & rsign){
+    if (!rhs){              // divide by 0 error
+        throw std::domain_error("Error: division or modulus by 0");
+    }
+
+    const INTEGER_DIGIT_T rem = div_digit(_value.data(), _value.data(), _value.size(), rhs);
+    _sign ^= rsign;
+    trim();
+    return rem;
+}
+
+INTEGER_DIGIT_T integer::div_digit(INTEGER_DIGIT_T * q, const INTEGER_DIGIT_T * u, const integer::REP_SIZE_T & usize, const INTEGER_DIGIT_T & rhs){
+    // divide from the most significant digit down, carrying the remainder
+    INTEGER_DOUBLE_DIGIT_T rem = 0;
+    for(integer::REP_SIZE_T i = usize; i > 0; i--){
+        const INTEGER_DOUBLE_DIGIT_T cur = (rem << integer::BITS) | u[i - 1];
+        q[i - 1] = static_cast <INTEGER_DIGIT_T> (cur / rhs);
+        rem = cur % rhs;
+    }
+    return static_cast <INTEGER_DIGIT_T> (rem);
+}
+
+INTEGER_DIGIT_T integer::mod_digit(const INTEGER_DIGIT_T & rhs) const {
+    if (!rhs){              // divide by 0 error
+        throw std::domain_error("Error: division or modulus by 0");
+    }
+
+    INTEGER_DOUBLE_DIGIT_T rem = 0;
+    for(integer::REP_SIZE_T i = _value.size(); i > 0; i--){
+        rem = ((rem << integer::BITS) | _value[i - 1]) % rhs;
+    }
+
+    return static_cast <INTEGER_DIGIT_T> (rem);
+}
+
+// division and modulus ignoring signs
+std::pair <integer, integer> integer::dm(const integer & lhs, const integer & rhs) const {
+    if (!rhs){              // divide by 0 error
+        throw std::domain_error("Error: division or modulus by 0");
+    }
+
+    if (rhs == 1){          // divide by 1 check
+        return {lhs, 0};
+    }
+    if (lhs == rhs){        // divide by same value check
+        return {1, 0};
+    }
+    if (!lhs){              // 0 / rhs check
+        return {0, 0};
+    }
+    if (lt(lhs, rhs)){      // lhs < rhs check
+        return {0, lhs};
+    }
+
+    // single digit divisors only need one pass
+    if (rhs._value.size() == 1){
+        std::pair <integer, integer> qr(lhs, 0);
+        qr.second = qr.first.div_digit(rhs._value[0], integer::POSITIVE);
+        return qr;
+    }
+
+    // return naive_divmod(lhs, rhs);
+    // return recursive_divmod(lhs, rhs);
+    if ((rhs._value.size() * integer::BITS) >= newton_threshold){
+        return reciprocal(rhs).dm(lhs);
+    }
+    if ((rhs._value.size() * integer::BITS) >= burnikel_ziegler_threshold){
+        return burnikel_ziegler(lhs, rhs);
+    }
+    return long_divmod(lhs, rhs);
 }
 
 // division and modulus with signs
 std::pair <integer, integer> integer::divmod(const integer & lhs, const integer & rhs) const {
     std::pair <integer, integer> out = dm(abs(lhs), abs(rhs));
     out.first._sign = lhs._sign ^ rhs._sign;
+    out.first.trim();                       // no negative 0
 
     if (lhs._sign == integer::NEGATIVE){
         out.second = -out.second;
@@ -1128,7 +2250,7 @@ integer integer::operator/(const integer & rhs) const {
 }
 
 integer & integer::operator/=(const integer & rhs){
-    return *this = *this / integer(rhs);
+    return *this = *this / rhs;
 }
 
 integer integer::operator%(const integer & rhs) const {
@@ -1139,6 +2261,806 @@ integer & integer::operator%=(const integer & rhs){
     return *this = *this % rhs;
 }
 
+integer integer::reciprocal::newton(const integer & d, const integer::REP_SIZE_T & m){
+    // small reciprocals come straight from long division
+    if (m <= std::max(karatsuba_threshold, static_cast <integer::REP_SIZE_T> (4 * integer::BITS))){
+        integer q = integer(1) << (2 * m);
+        if (d._value.size() == 1){
+            q.div_digit(d._value[0], integer::POSITIVE);
+            return q;
+        }
+        return d.long_divmod(q, d).first;
+    }
+
+    // the reciprocal of the top h bits of d is accurate to about h bits,
+    // so xh * 2^(m - h) is within about 2^(m - h) of 2^(2m) / d
+    const integer::REP_SIZE_T h = (m >> 1) + 8;
+    const integer::REP_SIZE_T low = m - h;
+    const integer xh = newton(d >> low, h);
+
+    // x = x + x * (2^(2m) - d * x) / 2^(2m)
+    // The low bits of x are 0, so only xh takes part in the products,
+    // and the low m - 8 bits of the error do not reach the result.
+    const integer e = (integer(1) << (2 * m)) - ((d * xh) << low);
+    integer x = xh << low;
+    if (e._sign == integer::POSITIVE){
+        x += (xh * (e >> (m - 8))) >> (h + 8);
+    }
+    else{
+        x -= (xh * (-e >> (m - 8))) >> (h + 8);
+    }
+
+    return x;
+}
+
+integer::reciprocal::reciprocal(const integer & divisor)
+    : _divisor(divisor),
+      _normalized(),
+      _inverse(),
+      _shift(0)
+{
+    if (!divisor){
+        throw std::domain_error("Error: division or modulus by 0");
+    }
+
+    for(INTEGER_DIGIT_T top = divisor._value.back(); !(top & integer::HIGH_BIT); top <<= 1){
+        _shift++;
+    }
+    _normalized = abs(divisor) << _shift;
+
+    // the normalized divisor is at least B^n / 2, so the reciprocal
+    // is in (B^n, 2 * B^n] and its top digit does not need to be stored.
+    // It is only within a few units of the floor, which dm corrects for.
+    const integer::REP_SIZE_T n = _normalized._value.size();
+    _inverse = newton(_normalized, n * integer::BITS);
+    _inverse -= integer(1) << (n * integer::BITS);
+    if (_inverse._sign == integer::NEGATIVE){
+        _inverse = 0;
+    }
+}
+
+const integer & integer::reciprocal::divisor() const {
+    return _divisor;
+}
+
+std::pair <integer, integer> integer::reciprocal::dm(const integer & lhs) const {
+    const integer::REP_SIZE_T n     = _normalized._value.size();
+    const integer::REP_SIZE_T usize = lhs._value.size();
+    const INTEGER_DIGIT_T * b = _normalized._value.data();
+    const integer::REP & inverse = _inverse._value;
+    if (!usize){
+        return {0, 0};
+    }
+
+    // the dividend is cut into n digit blocks the same way as in
+    // burnikel_ziegler, so the top block is less than the divisor
+    const integer::REP_SIZE_T blocks = usize / n + 1;
+    scratch_buffer <INTEGER_DIGIT_T> u(blocks * n, 0), estimate(n + inverse.size()), qi(n + 1), prod(2 * n + 1);
+    u[usize] = shift_left(u.data(), lhs._value.data(), usize, _shift);
+
+    // divide each pair of blocks from the top down, which leaves
+    // the remainder in the lower block for the next pair
+    const INTEGER_DIGIT_T one = 1;
+    integer::REP q((blocks - 1) * n);
+    for(integer::REP_SIZE_T i = blocks - 1; i > 0; i--){
+        INTEGER_DIGIT_T * t = u.data() + (i - 1) * n;
+        const INTEGER_DIGIT_T * top = t + n;
+
+        // t < _normalized * B^n, so the top n digits of t times the
+        // reciprocal, shifted down, is within a few units of the quotient
+        qi[n] = 0;
+        if (inverse.empty()){
+            std::copy(top, top + n, qi.data());
+        }
+        else{
+            mult(estimate.data(), top, n, inverse.data(), inverse.size());
+            qi[n] = add(qi.data(), top, n, estimate.data() + n, inverse.size());
+        }
+
+        // t -= qi * _normalized, with the digit above t as a signed value
+        mult(prod.data(), qi.data(), n + 1, b, n);
+        int above = -static_cast <int> (sub(t, t, 2 * n, prod.data(), 2 * n)) - static_cast <int> (prod[2 * n]);
+        while (above < 0){
+            above += add(t, t, 2 * n, b, n);
+            sub(qi.data(), qi.data(), n + 1, &one, 1);
+        }
+
+        integer::REP_SIZE_T size = 2 * n;
+        while (size && !t[size - 1]){
+            size--;
+        }
+        while (compare(t, size, b, n) >= 0){
+            sub(t, t, size, b, n);
+            add(qi.data(), qi.data(), n + 1, &one, 1);
+            while (size && !t[size - 1]){
+                size--;
+            }
+        }
+
+        std::copy(qi.data(), qi.data() + n, q.begin() + (i - 1) * n);
+    }
+
+    // shift the remainder back
+    integer::REP r(n);
+    for(integer::REP_SIZE_T i = 0; i < n; i++){
+        r[i] = (u[i] >> _shift) | ((_shift && ((i + 1) < n))?(u[i + 1] << (integer::BITS - _shift)):0);
+    }
+
+    return {integer(std::move(q)), integer(std::move(r))};
+}
+
+std::pair <integer, integer> integer::reciprocal::divmod(const integer & lhs) const {
+    std::pair <integer, integer> out = dm(abs(lhs));
+    out.first._sign = lhs._sign ^ _divisor._sign;
+    out.first.trim();                       // no negative 0
+
+    if (lhs._sign == integer::NEGATIVE){
+        out.second = -out.second;
+    }
+
+    return out;
+}
+
+integer integer::reciprocal::div(const integer & lhs) const {
+    return divmod(lhs).first;
+}
+
+integer integer::reciprocal::mod(const integer & lhs) const {
+    return divmod(lhs).second;
+}
+
+barrett_reducer::barrett_reducer(const integer & modulus)
+    : _modulus(modulus),
+      _m(abs(modulus)),
+      _mu(),
+      _n(modulus.digits())
+{
+    if (!modulus){
+        throw std::domain_error("Error: modulus by 0");
+    }
+
+    _mu = (integer(1) << (2 * _n * integer::BITS)) / _m;
+}
+
+const integer & barrett_reducer::modulus() const {
+    return _modulus;
+}
+
+integer barrett_reducer::reduce(const integer & value) const {
+    const integer::REP & x = value._value;
+    if (x.size() > (2 * _n)){
+        return value % _m;
+    }
+
+    // values with fewer digits than the modulus are already reduced
+    if (x.size() < _n){
+        return value;
+    }
+
+    // the estimate of the quotient is at most 2 too small
+    // (x has at most 2n digits, so t has at most n + 1)
+    const integer::REP & mu = _mu._value;
+    const integer::REP & m  = _m._value;
+    const integer::REP_SIZE_T tsize = x.size() - (_n - 1);
+    scratch_buffer <INTEGER_DIGIT_T> p(tsize + mu.size());
+    integer::mult(p.data(), x.data() + _n - 1, tsize, mu.data(), mu.size());
+    const INTEGER_DIGIT_T * q = p.data() + _n + 1;
+    const integer::REP_SIZE_T qsize = tsize + mu.size() - (_n + 1);
+
+    // x - q * m < 3m fits in n + 1 digits, so only
+    // the bottom n + 1 digits of the product are needed
+    const integer::REP_SIZE_T k = _n + 1;
+    const bool low = (k * integer::BITS) < integer::karatsuba_threshold;
+    scratch_buffer <INTEGER_DIGIT_T> qm(low?k:(qsize + m.size()));
+    if (low){
+        integer::long_mult_low(qm.data(), q, qsize, m.data(), m.size(), k);
+    }
+    else{
+        integer::mult(qm.data(), q, qsize, m.data(), m.size());
+    }
+
+    integer::REP r(k, 0);
+    std::copy(x.begin(), x.begin() + std::min(k, x.size()), r.begin());
+    integer::sub(r.data(), r.data(), k, qm.data(), k);
+
+    // the remainder takes the sign of the value
+    integer out(std::move(r), value._sign);
+    while (integer::compare(out._value.data(), out._value.size(), m.data(), m.size()) >= 0){
+        integer::sub(out._value.data(), out._value.data(), out._value.size(), m.data(), m.size());
+        out.trim();
+    }
+
+    return out;
+}
+
+montgomery_context::montgomery_context(const integer & modulus)
+    : _modulus(modulus),
+      _m(abs(modulus)),
+      _r2(),
+      _inverse(),
+      _digit(0),
+      _n(modulus.digits())
+{
+    if (!modulus[0]){
+        throw std::domain_error("Error: Montgomery modulus must be odd");
+    }
+
+    // m^-1 mod B by Newton iteration, where every step doubles the
+    // number of correct bits. m * m = 1 mod 8, so m starts with 3.
+    const INTEGER_DIGIT_T m0 = _m._value[0];
+    INTEGER_DIGIT_T inv = m0;
+    for(std::size_t bits = 3; bits < integer::BITS; bits <<= 1){
+        inv = static_cast <INTEGER_DIGIT_T> (inv * static_cast <INTEGER_DIGIT_T> (2 - static_cast <INTEGER_DIGIT_T> (m0 * inv)));
+    }
+    _digit = static_cast <INTEGER_DIGIT_T> (-inv);
+
+    // lift the inverse to m^-1 mod R the same way, with
+    // x = x * (2 - m * x) mod B^k doubling k every step
+    integer x = inv;
+    for(integer::REP_SIZE_T k = 1; k < _n;){
+        k = std::min(2 * k, _n);
+        const integer mx = integer::slice(_m._value.data(), _n, 0, k) * x;
+        const integer e = (integer(1) << (k * integer::BITS)) + 2 - integer::slice(mx._value.data(), mx._value.size(), 0, k);
+        const integer xe = x * e;
+        x = integer::slice(xe._value.data(), xe._value.size(), 0, k);
+    }
+    _inverse = (integer(1) << (_n * integer::BITS)) - x;
+
+    _r2 = (integer(1) << (2 * _n * integer::BITS)) % _m;
+}
+
+const integer & montgomery_context::modulus() const {
+    return _modulus;
+}
+
+integer montgomery_context::redc(const integer & value) const {
+    const integer::REP_SIZE_T n = _n;
+    const integer::REP & m = _m._value;
+
+    scratch_buffer <INTEGER_DIGIT_T> t(2 * n + 1, 0);
+    std::copy(value._value.begin(), value._value.end(), t.data());
+
+    // reducing with products needs two full multiplications,
+    // which only beats reducing one digit at a time once
+    // multiplication is well below quadratic
+    if ((n * integer::BITS) < integer::redc_threshold){
+        // add multiples of m that clear the bottom digit, one digit at a time
+        for(integer::REP_SIZE_T i = 0; i < n; i++){
+            const INTEGER_DIGIT_T q = static_cast <INTEGER_DIGIT_T> (t[i] * _digit);
+
+            INTEGER_DIGIT_T carry = 0;
+            for(integer::REP_SIZE_T j = 0; j < n; j++){
+                const INTEGER_DOUBLE_DIGIT_T prod = static_cast <INTEGER_DOUBLE_DIGIT_T> (q) * m[j] + t[i + j] + carry;
+                t[i + j] = static_cast <INTEGER_DIGIT_T> (prod);
+                carry    = static_cast <INTEGER_DIGIT_T> (prod >> integer::BITS);
+            }
+
+            for(integer::REP_SIZE_T k = i + n; carry; k++){
+                const INTEGER_DOUBLE_DIGIT_T sum = static_cast <INTEGER_DOUBLE_DIGIT_T> (t[k]) + carry;
+                t[k]  = static_cast <INTEGER_DIGIT_T> (sum);
+                carry = static_cast <INTEGER_DIGIT_T> (sum >> integer::BITS);
+            }
+        }
+    }
+    else{
+        // q = (value mod R) * -m^-1 mod R clears the bottom n digits of value + q * m
+        const integer::REP & inverse = _inverse._value;
+        scratch_buffer <INTEGER_DIGIT_T> low(n + inverse.size()), qm(2 * n);
+        integer::mult(low.data(), t.data(), n, inverse.data(), inverse.size());
+        integer::mult(qm.data(), low.data(), n, m.data(), n);
+        integer::add(t.data(), t.data(), 2 * n + 1, qm.data(), 2 * n);
+    }
+
+    // (value + q * m) / R < 2m
+    integer out(integer::REP(t.data() + n, t.data() + 2 * n + 1));
+    if (integer::compare(out._value.data(), out._value.size(), m.data(), n) >= 0){
+        integer::sub(out._value.data(), out._value.data(), out._value.size(), m.data(), n);
+        out.trim();
+    }
+
+    return out;
+}
+
+integer montgomery_context::to(const integer & value) const {
+    integer reduced = value % _m;
+    if (reduced < 0){
+        reduced += _m;
+    }
+    return redc(reduced * _r2);
+}
+
+integer montgomery_context::from(const integer & value) const {
+    return redc(value);
+}
+
+integer montgomery_context::mult(const integer & lhs, const integer & rhs) const {
+    return redc(lhs * rhs);
+}
+
+integer montgomery_context::sqr(const integer & value) const {
+    return redc(value.sqr());
+}
+
+integer montgomery_context::pow(const integer & base, const integer & exponent) const {
+    if (exponent < 0){
+        return 0;
+    }
+
+    if (!exponent){
+        return 1;
+    }
+
+    // exponentiation of the absolute value in Montgomery form
+    integer result = from(window_pow(to(abs(base)), exponent,
+                                     [this](const integer & lhs, const integer & rhs){ return mult(lhs, rhs); },
+                                     [this](const integer & value){ return sqr(value); }));
+
+    // the result takes the sign of the base raised to the exponent
+    if ((base < 0) && exponent[0]){
+        result = -result;
+    }
+
+    return result;
+}
+
+fixed_base_pow::fixed_base_pow(const integer & base, const integer & modulus, const integer::REP_SIZE_T & bits)
+    : _base(base),
+      _modulus(modulus),
+      _m(abs(modulus)),
+      _context(),
+      _window(1),
+      _powers()
+{
+    if (!modulus){
+        throw std::domain_error("Error: modulus by 0");
+    }
+
+    if (_m[0]){
+        _context = std::make_shared <const montgomery_context> (_m);
+    }
+
+    // pick the digit size with the fewest multiplications per exponent
+    const integer::REP_SIZE_T size = bits?bits:static_cast <integer::REP_SIZE_T> (_m.bits());
+    for(unsigned int k = 2; k < 16; k++){
+        if (((size + k - 1) / k + (1ULL << k)) < ((size + _window - 1) / _window + (1ULL << _window))){
+            _window = k;
+        }
+    }
+
+    // |base|^(2^(k * i))
+    integer power = _context?_context->to(abs(base)):(abs(base) % _m);
+    for(integer::REP_SIZE_T i = 0; i < size; i += _window){
+        _powers.push_back(power);
+        for(unsigned int j = 0; j < _window; j++){
+            power = _context?_context->sqr(power):(power.sqr() % _m);
+        }
+    }
+}
+
+integer fixed_base_pow::mult(const integer & lhs, const integer & rhs) const {
+    return _context?_context->mult(lhs, rhs):((lhs * rhs) % _m);
+}
+
+integer fixed_base_pow::pow(const integer & exponent) const {
+    if (exponent < 0){
+        return 0;
+    }
+
+    if (!exponent){
+        return 1;
+    }
+
+    const integer::REP_SIZE_T bits = static_cast <integer::REP_SIZE_T> (exponent.bits());
+    if (bits > (_powers.size() * _window)){
+        return ::pow(_base, exponent, _modulus);
+    }
+
+    // k bit digits of the exponent
+    const std::size_t digit_count = (bits + _window - 1) / _window;
+    std::vector <std::size_t> digits(digit_count, 0);
+    for(integer::REP_SIZE_T b = bits; b > 0; b--){
+        digits[(b - 1) / _window] = (digits[(b - 1) / _window] << 1) | exponent[b - 1];
+    }
+
+    // product over every digit value d of (product of powers with digit d)^d,
+    // found by keeping a running product of the powers from the largest
+    // digit down and multiplying it into the result at each step
+    integer result, running;
+    bool have_result = false, have_running = false;
+    for(std::size_t d = (static_cast <std::size_t> (1) << _window) - 1; d > 0; d--){
+        for(std::size_t i = 0; i < digit_count; i++){
+            if (digits[i] == d){
+                running = have_running?mult(running, _powers[i]):_powers[i];
+                have_running = true;
+            }
+        }
+
+        if (have_running){
+            result = have_result?mult(result, running):running;
+            have_result = true;
+        }
+    }
+
+    if (_context){
+        result = _context->from(result);
+    }
+
+    // the result takes the sign of the base raised to the exponent
+    if ((_base < 0) && exponent[0]){
+        result = -result;
+    }
+
+    return result;
+}
+
+// Views of digits stored elsewhere
+integer_view::integer_view() :
+    _digits(nullptr),
+    _size(0),
+    _sign(integer::POSITIVE)
+{}
+
+integer_view::integer_view(const integer & value) :
+    _digits(value._value.data()),
+    _size(value._value.size()),
+    _sign(value._sign)
+{}
+
+integer_view::integer_view(const INTEGER_DIGIT_T * digits, const integer::REP_SIZE_T & size, const integer::Sign & sign) :
+    _digits(digits),
+    _size(size),
+    _sign(sign)
+{
+    // skip top 0 digits instead of copying to trim them
+    while (_size && !_digits[_size - 1]){
+        _size--;
+    }
+    if (!_size){
+        _sign = integer::POSITIVE;
+    }
+}
+
+integer_view::integer_view(const integer_span & span) :
+    integer_view(span.data(), span.digits(), span.sign())
+{}
+
+int integer_view::compare(const integer_view & lhs, const integer_view & rhs){
+    if (lhs._sign != rhs._sign){
+        return (lhs._sign == integer::NEGATIVE)?-1:1;
+    }
+
+    const int out = integer::compare(lhs._digits, lhs._size, rhs._digits, rhs._size);
+    return (lhs._sign == integer::NEGATIVE)?-out:out;
+}
+
+integer_view integer_view::operator-() const {
+    integer_view out(*this);
+    out._sign = _size?!_sign:integer::POSITIVE;
+    return out;
+}
+
+const INTEGER_DIGIT_T * integer_view::data() const {
+    return _digits;
+}
+
+integer::REP_SIZE_T integer_view::digits() const {
+    return _size;
+}
+
+integer::Sign integer_view::sign() const {
+    return _sign;
+}
+
+integer integer_view::bits() const {
+    if (!_size){
+        return 0;
+    }
+
+    integer::REP_SIZE_T out = (_size - 1) * integer::BITS;
+    for(INTEGER_DIGIT_T msb = _digits[_size - 1]; msb; msb >>= 1){
+        out++;
+    }
+    return out;
+}
+
+bool integer_view::operator[](const integer::REP_SIZE_T & b) const {
+    if ((b / integer::BITS) >= _size){
+        return 0;
+    }
+    return (_digits[b / integer::BITS] >> (b % integer::BITS)) & 1;
+}
+
+integer_view::operator bool() const {
+    return _size;
+}
+
+bool operator==(const integer_view & lhs, const integer_view & rhs){ return integer_view::compare(lhs, rhs) == 0; }
+bool operator==(const integer_view & lhs, const integer      & rhs){ return integer_view::compare(lhs, rhs) == 0; }
+bool operator==(const integer      & lhs, const integer_view & rhs){ return integer_view::compare(lhs, rhs) == 0; }
+bool operator!=(const integer_view & lhs, const integer_view & rhs){ return integer_view::compare(lhs, rhs) != 0; }
+bool operator!=(const integer_view & lhs, const integer      & rhs){ return integer_view::compare(lhs, rhs) != 0; }
+bool operator!=(const integer      & lhs, const integer_view & rhs){ return integer_view::compare(lhs, rhs) != 0; }
+bool operator> (const integer_view & lhs, const integer_view & rhs){ return integer_view::compare(lhs, rhs) >  0; }
+bool operator> (const integer_view & lhs, const integer      & rhs){ return integer_view::compare(lhs, rhs) >  0; }
+bool operator> (const integer      & lhs, const integer_view & rhs){ return integer_view::compare(lhs, rhs) >  0; }
+bool operator>=(const integer_view & lhs, const integer_view & rhs){ return integer_view::compare(lhs, rhs) >= 0; }
+bool operator>=(const integer_view & lhs, const integer      & rhs){ return integer_view::compare(lhs, rhs) >= 0; }
+bool operator>=(const integer      & lhs, const integer_view & rhs){ return integer_view::compare(lhs, rhs) >= 0; }
+bool operator< (const integer_view & lhs, const integer_view & rhs){ return integer_view::compare(lhs, rhs) <  0; }
+bool operator< (const integer_view & lhs, const integer      & rhs){ return integer_view::compare(lhs, rhs) <  0; }
+bool operator< (const integer      & lhs, const integer_view & rhs){ return integer_view::compare(lhs, rhs) <  0; }
+bool operator<=(const integer_view & lhs, const integer_view & rhs){ return integer_view::compare(lhs, rhs) <= 0; }
+bool operator<=(const integer_view & lhs, const integer      & rhs){ return integer_view::compare(lhs, rhs) <= 0; }
+bool operator<=(const integer      & lhs, const integer_view & rhs){ return integer_view::compare(lhs, rhs) <= 0; }
+
+integer operator*(const integer_view & lhs, const integer_view & rhs){
+    if (!lhs || !rhs){
+        return 0;
+    }
+
+    integer out = integer::mult(lhs, rhs);
+    out._sign = lhs.sign() ^ rhs.sign();
+    return out.trim();
+}
+
+integer operator*(const integer_view & lhs, const integer & rhs){
+    return lhs * integer_view(rhs);
+}
+
+integer operator*(const integer & lhs, const integer_view & rhs){
+    return integer_view(lhs) * rhs;
+}
+
+std::pair <integer, integer> divmod(const integer_view & lhs, const integer_view & rhs){
+    if (!rhs){
+        throw std::domain_error("Error: division or modulus by 0");
+    }
+
+    // absolute values
+    const integer_view u(lhs.data(), lhs.digits());
+    const integer_view v(rhs.data(), rhs.digits());
+
+    std::pair <integer, integer> qr;
+    const int cmp = integer::compare(u.data(), u.digits(), v.data(), v.digits());
+    if (cmp < 0){
+        qr.second = integer(u);
+    }
+    else if (cmp == 0){
+        qr.first = 1;
+    }
+    else if (v.digits() == 1){
+        qr.first = integer(u);
+        qr.second = qr.first.div_digit(v.data()[0], integer::POSITIVE);
+    }
+    else if ((v.digits() * integer::BITS) < integer::burnikel_ziegler_threshold){
+        qr = integer::long_divmod(u, v);
+    }
+    else if ((v.digits() * integer::BITS) < integer::newton_threshold){
+        qr = integer::burnikel_ziegler(u, v);
+    }
+    else{
+        // Newton division normalizes copies of the values anyway
+        const integer a(u), b(v);
+        qr = a.dm(a, b);
+    }
+
+    qr.first._sign = lhs.sign() ^ rhs.sign();
+    qr.first.trim();
+    qr.second._sign = lhs.sign();
+    qr.second.trim();
+    return qr;
+}
+
+integer operator/(const integer_view & lhs, const integer_view & rhs){ return divmod(lhs, rhs).first;  }
+integer operator/(const integer_view & lhs, const integer      & rhs){ return divmod(lhs, rhs).first;  }
+integer operator/(const integer      & lhs, const integer_view & rhs){ return divmod(lhs, rhs).first;  }
+integer operator%(const integer_view & lhs, const integer_view & rhs){ return divmod(lhs, rhs).second; }
+integer operator%(const integer_view & lhs, const integer      & rhs){ return divmod(lhs, rhs).second; }
+integer operator%(const integer      & lhs, const integer_view & rhs){ return divmod(lhs, rhs).second; }
+
+std::ostream & operator<<(std::ostream & stream, const integer_view & rhs){
+    return stream << integer(rhs);
+}
+
+// Spans of caller owned digits
+integer_span::integer_span() :
+    _digits(nullptr),
+    _size(0),
+    _sign(integer::POSITIVE)
+{}
+
+integer_span::integer_span(INTEGER_DIGIT_T * digits, const integer::REP_SIZE_T & size, const integer::Sign & sign) :
+    _digits(digits),
+    _size(size),
+    _sign(sign)
+{}
+
+INTEGER_DIGIT_T * integer_span::data() const {
+    return _digits;
+}
+
+integer::REP_SIZE_T integer_span::digits() const {
+    return _size;
+}
+
+integer::Sign integer_span::sign() const {
+    return _sign;
+}
+
+namespace {
+
+// throws if out does not have room for size digits
+void require(const integer_span & out, const integer::REP_SIZE_T & size){
+    if (out.digits() < size){
+        throw std::runtime_error("Error: Output span is too small");
+    }
+}
+
+// span over the first size digits of out without top 0 digits
+integer_span result(const integer_span & out, integer::REP_SIZE_T size, const integer::Sign & sign){
+    while (size && !out.data()[size - 1]){
+        size--;
+    }
+    return integer_span(out.data(), size, size?sign:integer::POSITIVE);
+}
+
+// whether a view is looking at the digits of value
+bool aliases(const integer & value, const integer_view & view){
+    return view.digits() && (integer_view(value).data() == view.data());
+}
+
+}
+
+integer_span add(const integer_span & out, const integer_view & lhs, const integer_view & rhs){
+    // the operand with more digits goes first
+    const bool swap = lhs.digits() < rhs.digits();
+    const integer_view & a = swap?rhs:lhs;
+    const integer_view & b = swap?lhs:rhs;
+    require(out, a.digits() + 1);
+
+    // same sign: |a| + |b|
+    if (lhs.sign() == rhs.sign()){
+        out.data()[a.digits()] = integer::add(out.data(), a.data(), a.digits(), b.data(), b.digits());
+        return result(out, a.digits() + 1, lhs.sign());
+    }
+
+    // different signs: the larger magnitude minus the smaller one
+    if (integer::gt(b, a)){
+        integer::sub(out.data(), b.data(), b.digits(), a.data(), a.digits());
+        return result(out, b.digits(), b.sign());
+    }
+    integer::sub(out.data(), a.data(), a.digits(), b.data(), b.digits());
+    return result(out, a.digits(), a.sign());
+}
+
+integer_span sub(const integer_span & out, const integer_view & lhs, const integer_view & rhs){
+    return add(out, lhs, -rhs);
+}
+
+integer_span mult(const integer_span & out, const integer_view & lhs, const integer_view & rhs){
+    if (!lhs || !rhs){
+        return integer_span(out.data(), 0);
+    }
+
+    require(out, lhs.digits() + rhs.digits());
+    integer::mult(out.data(), lhs.data(), lhs.digits(), rhs.data(), rhs.digits());
+    return result(out, lhs.digits() + rhs.digits(), lhs.sign() ^ rhs.sign());
+}
+
+std::pair <integer_span, integer_span> divmod(const integer_span & quotient, const integer_span & remainder, const integer_view & lhs, const integer_view & rhs){
+    if (!rhs){
+        throw std::domain_error("Error: division or modulus by 0");
+    }
+
+    const integer::REP_SIZE_T usize = lhs.digits();
+    const integer::REP_SIZE_T vsize = rhs.digits();
+    const integer::REP_SIZE_T qsize = (usize >= vsize)?(usize - vsize + 1):1;
+    require(quotient, qsize);
+    require(remainder, vsize);
+
+    INTEGER_DIGIT_T * q = quotient.data();
+    INTEGER_DIGIT_T * r = remainder.data();
+
+    // absolute values
+    const integer_view u(lhs.data(), usize);
+    const integer_view v(rhs.data(), vsize);
+
+    if (integer::lt(u, v)){
+        std::fill(q, q + qsize, 0);
+        std::copy(u.data(), u.data() + usize, r);
+        std::fill(r + usize, r + vsize, 0);
+    }
+    else if (vsize == 1){
+        r[0] = integer::div_digit(q, u.data(), usize, v.data()[0]);
+    }
+    else if ((vsize * integer::BITS) < integer::burnikel_ziegler_threshold){
+        integer::long_divmod(q, r, u, v);
+    }
+    else if ((vsize * integer::BITS) < integer::newton_threshold){
+        integer::burnikel_ziegler(q, r, u, v);
+    }
+    else{
+        // Newton division normalizes copies of the values anyway
+        const integer a(u), b(v);
+        const std::pair <integer, integer> qr = a.dm(a, b);
+        std::fill(std::copy(qr.first._value.begin(),  qr.first._value.end(),  q), q + qsize, 0);
+        std::fill(std::copy(qr.second._value.begin(), qr.second._value.end(), r), r + vsize, 0);
+    }
+
+    return {result(quotient, qsize, lhs.sign() ^ rhs.sign()), result(remainder, vsize, lhs.sign())};
+}
+
+integer & add(integer & out, const integer_view & lhs, const integer_view & rhs){
+    const integer::REP_SIZE_T size = std::max(lhs.digits(), rhs.digits()) + 1;
+
+    // out may be one of the operands, so its digits are only
+    // kept in place when it does not have to grow
+    if (aliases(out, lhs) || aliases(out, rhs)){
+        if (out._value.capacity() < size){
+            integer sum;
+            add(sum, lhs, rhs);
+            return out = std::move(sum);
+        }
+    }
+    else{
+        out._value.clear();
+    }
+
+    out._value.resize(size);
+    const integer_span sum = add(integer_span(out._value.data(), size), lhs, rhs);
+    out._value.resize(sum.digits());
+    out._sign = sum.sign();
+    return out;
+}
+
+integer & sub(integer & out, const integer_view & lhs, const integer_view & rhs){
+    return add(out, lhs, -rhs);
+}
+
+integer & mult(integer & out, const integer_view & lhs, const integer_view & rhs){
+    // the product cannot be written over its operands
+    if (aliases(out, lhs) || aliases(out, rhs)){
+        integer product;
+        mult(product, lhs, rhs);
+        return out = std::move(product);
+    }
+
+    const integer::REP_SIZE_T size = lhs.digits() + rhs.digits();
+    out._value.clear();
+    out._value.resize(size);
+    const integer_span product = mult(integer_span(out._value.data(), size), lhs, rhs);
+    out._value.resize(product.digits());
+    out._sign = product.sign();
+    return out;
+}
+
+void divmod(integer & quotient, integer & remainder, const integer_view & lhs, const integer_view & rhs){
+    if (!rhs){
+        throw std::domain_error("Error: division or modulus by 0");
+    }
+
+    if (aliases(quotient, lhs) || aliases(quotient, rhs) || aliases(remainder, lhs) || aliases(remainder, rhs)){
+        integer q, r;
+        divmod(q, r, lhs, rhs);
+        quotient = std::move(q);
+        remainder = std::move(r);
+        return;
+    }
+
+    const integer::REP_SIZE_T qsize = (lhs.digits() >= rhs.digits())?(lhs.digits() - rhs.digits() + 1):1;
+    const integer::REP_SIZE_T rsize = rhs.digits();
+    quotient._value.clear();
+    quotient._value.resize(qsize);
+    remainder._value.clear();
+    remainder._value.resize(rsize);
+
+    const std::pair <integer_span, integer_span> qr = divmod(integer_span(quotient._value.data(), qsize), integer_span(remainder._value.data(), rsize), lhs, rhs);
+    quotient._value.resize(qr.first.digits());
+    quotient._sign = qr.first.sign();
+    remainder._value.resize(qr.second.digits());
+    remainder._sign = qr.second.sign();
+}
+
 // Prefix ++
 integer & integer::operator++(){
     return *this += 1;
@@ -1180,20 +3102,13 @@ integer::Sign integer::sign() const {
 
 // get minimum number of bits needed to hold this value
 integer integer::bits() const {
-    integer         out = integer(_value.empty()?0:(_value.size() - 1)) * integer::BITS;
-    INTEGER_DIGIT_T msb = _value.empty()?0:_value[0];
-    while (msb){
-        msb >>= 1;
-        out++;
-    }
-
-    return out;
+    return bit_count();
 }
 
 // get minimum number of bytes needed to hold this value
 integer::REP_SIZE_T integer::bytes() const {
     integer::REP_SIZE_T out = (_value.empty()?0:(_value.size() - 1)) * integer::OCTETS;
-    INTEGER_DIGIT_T     msb = (_value.empty()?0:_value[0]);
+    INTEGER_DIGIT_T     msb = (_value.empty()?0:_value.back());
     while (msb){
         msb >>= 8;
         out++;
@@ -1218,6 +3133,23 @@ integer & integer::negate(){
     return trim();
 }
 
+void integer::twos_complement(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * value, const integer::REP_SIZE_T & size, const integer::REP_SIZE_T & b){
+    const integer::REP_SIZE_T width = (b + integer::BITS - 1) / integer::BITS;
+
+    // invert and add 1, carrying through the digits that become 0
+    bool carry = true;
+    for(integer::REP_SIZE_T i = 0; i < width; i++){
+        const INTEGER_DIGIT_T d = static_cast <INTEGER_DIGIT_T> (~((i < size)?value[i]:0) + carry);
+        carry = carry && !d;
+        out[i] = d;
+    }
+
+    // drop the bits above b
+    if (b % integer::BITS){
+        out[width - 1] &= (static_cast <INTEGER_DIGIT_T> (1) << (b % integer::BITS)) - 1;
+    }
+}
+
 integer integer::twos_complement(const integer::REP_SIZE_T & b) const {
     integer mask; mask.fill(b);
     integer out = ((abs(*this) ^ mask) + 1) & mask;
@@ -1229,52 +3161,60 @@ integer integer::twos_complement(const integer::REP_SIZE_T & b) const {
 integer & integer::fill(const integer::REP_SIZE_T & b){
     _value = integer::REP(b / integer::BITS, integer::NEG1);
     if (b % integer::BITS){
-        _value.push_front((1 << (b % integer::BITS)) - 1);
+        _value.push_back((static_cast <INTEGER_DIGIT_T> (1) << (b % integer::BITS)) - 1);
     }
     return *this;
 }
 
 // get bit, where 0 is the lsb and bits() - 1 is the msb
 bool integer::operator[](const integer::REP_SIZE_T & b) const {
-    if (b >= bits()){ // if given index is larger than bits in this _value, return 0
+    if ((b / integer::BITS) >= _value.size()){ // if given index is larger than bits in this _value, return 0
         return 0;
     }
-    return (_value[_value.size() - (b / integer::BITS) - 1] >> (b % integer::BITS)) & 1;
+    return (_value[b / integer::BITS] >> (b % integer::BITS)) & 1;
 }
 
 // Output value as a string from base 2 to 16, or base 256
 std::string integer::str(const integer & base, const std::string::size_type & length) const {
     std::string out = "";
     if ((2 <= base) && (base <= 16)){
-        static const std::string digits = "0123456789abcdef";
-        integer rhs = abs(*this);       // use absolute value to make sure index stays small
-        if (*this == 0){
-            out = "0";
-        }
-        else{
-            std::pair <integer, integer> qr;
-            do{
-                qr = dm(rhs, base);
-                out = digits[qr.second] + out;
-                rhs = qr.first;
-            } while (rhs);
+        const INTEGER_DIGIT_T b = base._value[0];
+        const std::string::size_type sign = (_sign == integer::NEGATIVE);
+        const std::string::size_type width = std::max(to_chars_length(*this, b) - sign, length);
+
+        // the digits are copied straight into the string
+        struct string_sink{
+            char * out;
+            void operator()(const char * characters, const std::size_t & count){
+                std::memcpy(out, characters, count);
+                out += count;
+            }
+        };
+
+        out.resize(sign + width);
+        if (sign){
+            out[0] = '-';
         }
+        string_sink sink = {&out[sign]};
+        write_digits(sink, b, width, LOWER_DIGITS);
 
-        // pad with '0's
-        if (out.size() < length){
-            out = std::string(length - out.size(), '0') + out;
+        // to_chars_length leaves room for one more digit right below a
+        // power of the base, which comes out as a leading '0'
+        if ((width > length) && (width > 1) && (out[sign] == '0')){
+            out.erase(sign, 1);
         }
+        return out;
     }
     else if (base == 256){
         if (_value.empty()){
             out = std::string(1, 0);
         }
         else{
-            // for each digit
-            for(INTEGER_DIGIT_T const & d : _value){
+            // for each digit, starting from the most significant
+            for(integer::REP::const_reverse_iterator d = _value.rbegin(); d != _value.rend(); d++){
                 // write out each character
                 for(std::size_t i = integer::OCTETS << 3; i > 0; i -= 8){
-                    out += std::string(1, (d >> (i - 8)) & 0xff);
+                    out += std::string(1, (*d >> (i - 8)) & 0xff);
                 }
             }
 
@@ -1309,6 +3249,182 @@ std::string integer::str(const integer & base, const std::string::size_type & le
     return out;
 }
 
+void integer::str_pow2(char * out, const std::size_t & first, const std::size_t & count, const unsigned int & shift, const char * digits) const {
+    std::size_t i = first;
+    const std::size_t end = first + count;
+
+    // hexadecimal characters never straddle digits, so whole bytes are
+    // looked up in a table of character pairs
+    if ((shift == 4) && !(first % (integer::OCTETS << 1))){
+        struct hex_pairs{
+            char pairs[512];
+            hex_pairs(const char * digits){
+                for(unsigned int c = 0; c < 256; c++){
+                    pairs[2 * c]     = digits[c >> 4];
+                    pairs[2 * c + 1] = digits[c & 15];
+                }
+            }
+        };
+        static const hex_pairs lower(LOWER_DIGITS), upper(UPPER_DIGITS);
+        const char * table = (digits == UPPER_DIGITS)?upper.pairs:lower.pairs;
+
+        for(integer::REP_SIZE_T d = first / (integer::OCTETS << 1); (d < _value.size()) && ((end - i) >= (integer::OCTETS << 1)); d++){
+            INTEGER_DIGIT_T digit = _value[d];
+            for(std::size_t octet = 0; octet < integer::OCTETS; octet++){
+                out -= 2;
+                std::memcpy(out, table + 2 * (digit & 0xff), 2);
+                digit = static_cast <INTEGER_DIGIT_T> (digit >> 7 >> 1);
+            }
+            i += integer::OCTETS << 1;
+        }
+    }
+
+    // one character at a time, taking bits from the next digit when
+    // a group straddles two of them (octal)
+    const INTEGER_DIGIT_T mask = static_cast <INTEGER_DIGIT_T> ((static_cast <INTEGER_DIGIT_T> (1) << shift) - 1);
+    for(; i < end; i++){
+        const integer::REP_SIZE_T bit = static_cast <integer::REP_SIZE_T> (i) * shift;
+        const integer::REP_SIZE_T d = bit / integer::BITS;
+        if (d >= _value.size()){
+            break;
+        }
+
+        const std::size_t offset = bit % integer::BITS;
+        INTEGER_DIGIT_T group = static_cast <INTEGER_DIGIT_T> (_value[d] >> offset);
+        if (((offset + shift) > integer::BITS) && ((d + 1) < _value.size())){
+            group |= static_cast <INTEGER_DIGIT_T> (_value[d + 1] << (integer::BITS - offset));
+        }
+        *--out = digits[group & mask];
+    }
+
+    std::fill(out - (end - i), out, '0');
+}
+
+void integer::from_pow2(const char * first, const char * last, const unsigned int & shift, const uint8_t * values){
+    const std::size_t count = last - first;
+    _value.clear();
+    _value.resize((count * shift + integer::BITS - 1) / integer::BITS);
+
+    for(std::size_t i = 0; i < count; i++){
+        const INTEGER_DIGIT_T d = values[static_cast <unsigned char> (first[i])];
+
+        // octal groups can straddle two digits
+        const integer::REP_SIZE_T bit = static_cast <integer::REP_SIZE_T> (count - 1 - i) * shift;
+        const integer::REP_SIZE_T digit = bit / integer::BITS;
+        const std::size_t offset = bit % integer::BITS;
+        _value[digit] |= static_cast <INTEGER_DIGIT_T> (d << offset);
+        if ((offset + shift) > integer::BITS){
+            _value[digit + 1] |= static_cast <INTEGER_DIGIT_T> (d >> (integer::BITS - offset));
+        }
+    }
+
+    trim();
+}
+
+template <typename Sink>
+void integer::write_digits(Sink & sink, const INTEGER_DIGIT_T & base, const std::size_t & width, const char * digits) const {
+    // bases 2, 4, 8, and 16 write blocks of characters from the top down
+    if (!(base & (base - 1))){
+        unsigned int shift = 1;
+        while ((static_cast <INTEGER_DIGIT_T> (1) << shift) < base){
+            shift++;
+        }
+
+        const std::size_t block = 4096;
+        char buffer[block];
+        std::size_t remaining = width;
+        while (remaining){
+            const std::size_t count = (remaining % block)?(remaining % block):block;
+            remaining -= count;
+            str_pow2(buffer + count, remaining, count, shift, digits);
+            sink(static_cast <const char *> (buffer), count);
+        }
+        return;
+    }
+
+    // largest power of the base that fits in a digit
+    const integer::REP_SIZE_T per_chunk = chunk_digits(base);
+    INTEGER_DIGIT_T chunk = 1;
+    for(integer::REP_SIZE_T i = 0; i < per_chunk; i++){
+        chunk = static_cast <INTEGER_DIGIT_T> (chunk * base);
+    }
+
+    // chunk^(2^i), up to about the size of the value, one after another on
+    // the scratch stack. Each square is at most as long as the value and
+    // almost twice as long as the power before it, so all of them fit in
+    // twice the size of the value, plus a digit per level.
+    const std::size_t levels = sizeof(integer::REP_SIZE_T) << 3;
+    scratch_buffer <INTEGER_DIGIT_T> room(2 * (_value.size() + levels) + 1);
+    integer_view powers[levels];
+    INTEGER_DIGIT_T * next = room.data();
+    *next = chunk;
+    powers[0] = integer_view(next++, 1);
+    std::size_t count = 1;
+    while ((count < levels) && ((powers[count - 1].digits() << 1) <= _value.size())){
+        const integer_view & p = powers[count - 1];
+        mult(next, p.data(), p.digits(), p.data(), p.digits());
+        powers[count++] = integer_view(next, 2 * p.digits());
+        next += 2 * p.digits();
+    }
+
+    write_split(sink, width, integer_view(_value.data(), _value.size()), powers, count - 1, base, per_chunk, digits);
+}
+
+template <typename Sink>
+void integer::write_split(Sink & sink, const std::size_t & width, const integer_view & value, const integer_view * powers, integer::REP_SIZE_T level, const INTEGER_DIGIT_T & base, const std::size_t & per_chunk, const char * digits){
+    // use the largest power that is not longer than the value
+    while (level && (powers[level].digits() > value.digits())){
+        level--;
+    }
+
+    // values of up to about 1024 bits are written out one chunk of digits
+    // at a time, which is faster than splitting them any further
+    if (!level || (value.digits() <= (1024 / integer::BITS))){
+        char buffer[1024];
+        char * start = buffer + sizeof(buffer);
+        scratch_buffer <INTEGER_DIGIT_T> rest(value.digits());
+        std::copy(value.data(), value.data() + value.digits(), rest.data());
+        for(integer::REP_SIZE_T size = value.digits(); size;){
+            INTEGER_DIGIT_T r = div_digit(rest.data(), rest.data(), size, powers[0].data()[0]);
+            while (size && !rest[size - 1]){
+                size--;
+            }
+            for(std::size_t i = 0; i < per_chunk; i++){
+                *--start = digits[r % base];
+                r = static_cast <INTEGER_DIGIT_T> (r / base);
+            }
+        }
+
+        // the top chunk can have leading '0's
+        while ((start != (buffer + sizeof(buffer))) && (*start == '0')){
+            start++;
+        }
+        const std::size_t count = (buffer + sizeof(buffer)) - start;
+
+        // pad with '0's
+        char zeros[256];
+        std::fill(zeros, zeros + sizeof(zeros), '0');
+        for(std::size_t padding = width - count; padding;){
+            const std::size_t n = std::min(padding, sizeof(zeros));
+            sink(static_cast <const char *> (zeros), n);
+            padding -= n;
+        }
+
+        sink(static_cast <const char *> (start), count);
+        return;
+    }
+
+    // value = q * powers[level] + r, where r is written with exactly per_chunk * 2^level digits
+    const std::size_t low = per_chunk << level;
+    const integer_view & power = powers[level];
+    scratch_buffer <INTEGER_DIGIT_T> q(value.digits() - power.digits() + 1), r(power.digits());
+    const std::pair <integer_span, integer_span> qr = ::divmod(integer_span(q.data(), q.size()), integer_span(r.data(), r.size()), value, power);
+    if (width > low){
+        write_split(sink, width - low, qr.first, powers, level, base, per_chunk, digits);
+    }
+    write_split(sink, std::min(low, width), qr.second, powers, level - 1, base, per_chunk, digits);
+}
+
 // Bitshift Operators
 integer operator<<(const bool & lhs, const integer & rhs){
     return integer(lhs) << rhs;
@@ -1384,19 +3500,114 @@ integer operator>>(const int64_t & lhs, const integer & rhs){
 
 // IO Operators
 std::ostream & operator<<(std::ostream & stream, const integer & rhs){
-    if (stream.flags() & stream.oct){
-        stream << rhs.str(8);
+    std::ostream::sentry sentry(stream);
+    if (!sentry){
+        return stream;
     }
-    else if (stream.flags() & stream.hex){
-        stream << rhs.str(16);
+
+    const std::ios_base::fmtflags flags = stream.flags();
+    int base = 10;
+    if (flags & stream.oct){
+        base = 8;
     }
-    else{
-        stream << rhs.str(10);
+    else if (flags & stream.hex){
+        base = 16;
+    }
+
+    // sign and base prefix
+    char prefix[3];
+    std::size_t prefix_size = 0;
+    if (rhs._sign == integer::NEGATIVE){
+        prefix[prefix_size++] = '-';
+    }
+    else if (flags & stream.showpos){
+        prefix[prefix_size++] = '+';
+    }
+    if ((flags & stream.showbase) && (base != 10) && rhs){
+        prefix[prefix_size++] = '0';
+        if (base == 16){
+            prefix[prefix_size++] = (flags & stream.uppercase)?'X':'x';
+        }
+    }
+
+    // to_chars_length leaves room for one more digit right below a power of
+    // the base, which comes out as a leading '0', so the prefix and padding
+    // are only written once the first characters show how many digits there are
+    const std::size_t digits = to_chars_length(rhs, base) - (rhs._sign == integer::NEGATIVE);
+    const std::ios_base::fmtflags adjust = flags & stream.adjustfield;
+
+    // write into the stream buffer directly
+    struct stream_sink{
+        std::streambuf * buffer;
+        bool good;
+        const char * prefix;
+        std::size_t prefix_size;
+        std::size_t digits;
+        std::streamsize width;
+        std::ios_base::fmtflags adjust;
+        char fill_char;
+        bool started;
+        std::size_t padding;
+
+        void operator()(const char * characters, std::size_t count){
+            if (!count){
+                return;
+            }
+            if (!started){
+                if ((digits > 1) && (*characters == '0')){
+                    characters++;
+                    count--;
+                    digits--;
+                }
+                start();
+            }
+            good = good && (buffer -> sputn(characters, count) == static_cast <std::streamsize> (count));
+        }
+
+        void start(){
+            started = true;
+            padding = (width > static_cast <std::streamsize> (prefix_size + digits))?(width - prefix_size - digits):0;
+            if ((adjust != std::ios_base::left) && (adjust != std::ios_base::internal)){
+                fill(fill_char, padding);
+            }
+            good = good && (buffer -> sputn(prefix, prefix_size) == static_cast <std::streamsize> (prefix_size));
+            if (adjust == std::ios_base::internal){
+                fill(fill_char, padding);
+            }
+        }
+
+        void fill(const char & c, std::size_t count){
+            for(; good && count; count--){
+                good = (buffer -> sputc(c) != std::char_traits <char>::eof());
+            }
+        }
+    };
+
+    stream_sink sink = {stream.rdbuf(), true, prefix, prefix_size, digits, stream.width(), adjust, stream.fill(), false, 0};
+    stream.width(0);
+    rhs.write_digits(sink, base, digits, (flags & stream.uppercase)?UPPER_DIGITS:LOWER_DIGITS);
+    if (!sink.started){
+        sink.start();
+    }
+    if (adjust == stream.left){
+        sink.fill(sink.fill_char, sink.padding);
+    }
+
+    if (!sink.good){
+        stream.setstate(stream.badbit);
     }
+
     return stream;
 }
 
 std::istream & operator>>(std::istream & stream, integer & rhs){
+    // skip whitespace
+    std::istream::sentry sentry(stream);
+    if (!sentry){
+        rhs = 0;
+        return stream;
+    }
+
     uint8_t base;
     if (stream.flags() & stream.oct){
         base = 8;
@@ -1407,9 +3618,72 @@ std::istream & operator>>(std::istream & stream, integer & rhs){
     else{
         base = 10;
     }
-    std::string in;
-    stream >> in;
-    rhs = integer(in, base);
+
+    // at most width characters, if it is set
+    std::streamsize limit = stream.width();
+    if (limit <= 0){
+        limit = std::numeric_limits <std::streamsize>::max();
+    }
+    stream.width(0);
+
+    // characters are read up to the next whitespace and packed into chunks
+    // as they arrive, without keeping the string around
+    const std::ctype <char> & ctype = std::use_facet <std::ctype <char> > (stream.getloc());
+    const uint8_t * values = digit_values();
+    const integer::REP_SIZE_T per_chunk = integer::chunk_digits(base);
+    std::vector <INTEGER_DIGIT_T> chunks;
+    INTEGER_DIGIT_T tail = 0;
+    integer::REP_SIZE_T tail_digits = 0;
+    std::size_t count = 0;
+    bool negative = false;
+
+    std::streambuf * buffer = stream.rdbuf();
+    int c = buffer -> sgetc();
+    if ((c == '-') && limit){
+        negative = true;
+        limit--;
+        c = buffer -> snextc();
+    }
+
+    for(; (c != std::char_traits <char>::eof()) && limit && !ctype.is(std::ctype_base::space, static_cast <char> (c)); limit--, c = buffer -> snextc()){
+        const uint8_t d = values[static_cast <unsigned char> (c)];
+        if (d >= base){
+            // "0x" in front of hexadecimal digits
+            if ((base == 16) && (count == 1) && !tail && ((c == 'x') || (c == 'X'))){
+                chunks.clear();
+                count = 0;
+                tail_digits = 0;
+                continue;
+            }
+
+            throw std::runtime_error(std::string("Error: Not a digit in base ") + std::to_string(base) + ": '" + static_cast <char> (c) + "'");
+        }
+
+        tail = static_cast <INTEGER_DIGIT_T> (tail * base + d);
+        if (++tail_digits == per_chunk){
+            chunks.push_back(tail);
+            tail = 0;
+            tail_digits = 0;
+        }
+        count++;
+    }
+
+    if (c == std::char_traits <char>::eof()){
+        stream.setstate(stream.eofbit);
+    }
+
+    if (!count){
+        if (negative){
+            throw std::runtime_error("Error: Input string is too short");
+        }
+        stream.setstate(stream.failbit);
+        rhs = 0;
+        return stream;
+    }
+
+    rhs = integer::from_chunks(chunks, base, per_chunk, tail, tail_digits);
+    rhs._sign = negative?integer::NEGATIVE:integer::POSITIVE;
+    rhs.trim();
     return stream;
 }
 
@@ -1429,6 +3703,412 @@ std::string makeascii(const integer & value, const unsigned int & size){
     return value.str(256, size);
 }
 
+std::size_t to_chars_length(const integer & value, const int & base){
+    if (((base < 2) || (base > 16)) && (base != 256)){
+        return 0;
+    }
+
+    if (!value){
+        return 1;
+    }
+
+    const std::size_t sign = (value._sign == integer::NEGATIVE);
+    const integer::REP_SIZE_T bits = value.bit_count();
+
+    if (base == 256){
+        return sign + (bits + 7) / 8;
+    }
+
+    // powers of 2
+    if (!(base & (base - 1))){
+        unsigned int shift = 1;
+        while ((1 << shift) < base){
+            shift++;
+        }
+        return sign + (bits + shift - 1) / shift;
+    }
+
+    // count the digits of small values directly
+    if (bits <= 64){
+        uint64_t rest = 0;
+        for(integer::REP_SIZE_T i = value._value.size(); i > 0; i--){
+            rest = (rest << 7 << (integer::BITS - 7)) | value._value[i - 1];
+        }
+
+        std::size_t length = 0;
+        for(; rest; rest /= base){
+            length++;
+        }
+        return sign + length;
+    }
+
+    // log2 of the value from at least its top 64 bits
+    double top = 0;
+    integer::REP_SIZE_T used = 0;
+    for(integer::REP_SIZE_T i = value._value.size(); (i > 0) && (used < 64 + integer::BITS); i--){
+        top = top * std::ldexp(1.0, integer::BITS) + value._value[i - 1];
+        used += integer::BITS;
+    }
+    const double digits = (std::log2(top) + (value._value.size() * integer::BITS - used)) / std::log2(static_cast <double> (base));
+
+    // close to a power of the base, where the estimate cannot tell
+    // which side of it the value is on, so leave room for either
+    const double nearest = std::floor(digits + 0.5);
+    if (std::fabs(digits - nearest) < (digits * 1e-14 + 1e-9)){
+        return sign + static_cast <std::size_t> (nearest) + 1;
+    }
+
+    return sign + static_cast <std::size_t> (digits) + 1;
+}
+
+integer::to_chars_result to_chars(char * first, char * last, const integer & value, const int & base){
+    const integer::to_chars_result too_large = {last, std::errc::value_too_large};
+
+    if (((base < 2) || (base > 16)) && (base != 256)){
+        const integer::to_chars_result invalid = {first, std::errc::invalid_argument};
+        return invalid;
+    }
+
+    char * out = first;
+    if (value._sign == integer::NEGATIVE){
+        if (out == last){
+            return too_large;
+        }
+        *out++ = '-';
+    }
+
+    // bytes and powers of 2 come straight from the bits
+    if ((base == 256) || !(base & (base - 1))){
+        const std::size_t length = to_chars_length(value, base) - (out - first);
+        if (static_cast <std::size_t> (last - out) < length){
+            return too_large;
+        }
+
+        if (base == 256){
+            for(std::size_t i = 0; i < length; i++){
+                const integer::REP_SIZE_T digit = i / integer::OCTETS;
+                out[length - 1 - i] = (digit < value._value.size())?static_cast <char> ((value._value[digit] >> ((i % integer::OCTETS) << 3)) & 0xff):0;
+            }
+        }
+        else{
+            unsigned int shift = 1;
+            while ((1 << shift) < base){
+                shift++;
+            }
+            value.str_pow2(out + length, 0, length, shift, LOWER_DIGITS);
+        }
+
+        const integer::to_chars_result result = {out + length, std::errc()};
+        return result;
+    }
+
+    // other bases are divided by the largest power of the base that fits in
+    // a digit, writing the least significant characters first
+    const INTEGER_DIGIT_T b = static_cast <INTEGER_DIGIT_T> (base);
+    const integer::REP_SIZE_T per_chunk = integer::chunk_digits(b);
+    INTEGER_DIGIT_T chunk = 1;
+    for(integer::REP_SIZE_T i = 0; i < per_chunk; i++){
+        chunk = static_cast <INTEGER_DIGIT_T> (chunk * b);
+    }
+
+    // Short quotients are kept on the stack. Longer ones are kept in the
+    // end of the buffer, most significant digit first, where they stay out of
+    // the way of the characters, since a quotient of more than 256 bits takes
+    // up fewer bytes than the characters that it still has to produce.
+    INTEGER_DIGIT_T local[(256 / integer::BITS)];
+    const integer::REP_SIZE_T local_size = sizeof(local) / sizeof(local[0]);
+    integer::REP_SIZE_T n = value._value.size();
+    char * d = out;
+
+    if (n > local_size){
+        if (static_cast <std::size_t> (last - out) < n * integer::OCTETS){
+            return too_large;
+        }
+
+        for(integer::REP_SIZE_T i = 0; i < n; i++){
+            std::memcpy(last - (i + 1) * integer::OCTETS, &value._value[i], integer::OCTETS);
+        }
+
+        while (n > local_size){
+            INTEGER_DOUBLE_DIGIT_T rem = 0;
+            for(integer::REP_SIZE_T i = n; i > 0; i--){
+                char * digit = last - i * integer::OCTETS;
+                INTEGER_DIGIT_T q;
+                std::memcpy(&q, digit, integer::OCTETS);
+                const INTEGER_DOUBLE_DIGIT_T cur = (rem << integer::BITS) | q;
+                q = static_cast <INTEGER_DIGIT_T> (cur / chunk);
+                rem = cur % chunk;
+                std::memcpy(digit, &q, integer::OCTETS);
+            }
+
+            // drop leading zero digits
+            while (n){
+                INTEGER_DIGIT_T top;
+                std::memcpy(&top, last - n * integer::OCTETS, integer::OCTETS);
+                if (top){
+                    break;
+                }
+                n--;
+            }
+
+            // move short quotients onto the stack
+            if (n <= local_size){
+                for(integer::REP_SIZE_T i = 0; i < n; i++){
+                    std::memcpy(&local[i], last - (i + 1) * integer::OCTETS, integer::OCTETS);
+                }
+            }
+
+            const char * limit = (n > local_size)?(last - n * integer::OCTETS):last;
+            if (static_cast <std::size_t> (limit - d) < per_chunk){
+                return too_large;
+            }
+
+            INTEGER_DIGIT_T r = static_cast <INTEGER_DIGIT_T> (rem);
+            for(integer::REP_SIZE_T i = 0; i < per_chunk; i++){
+                *d++ = LOWER_DIGITS[r % b];
+                r = static_cast <INTEGER_DIGIT_T> (r / b);
+            }
+        }
+    }
+    else{
+        std::copy(value._value.begin(), value._value.end(), local);
+    }
+
+    while (n){
+        INTEGER_DOUBLE_DIGIT_T rem = 0;
+        for(integer::REP_SIZE_T i = n; i > 0; i--){
+            const INTEGER_DOUBLE_DIGIT_T cur = (rem << integer::BITS) | local[i - 1];
+            local[i - 1] = static_cast <INTEGER_DIGIT_T> (cur / chunk);
+            rem = cur % chunk;
+        }
+
+        while (n && !local[n - 1]){
+            n--;
+        }
+
+        // the last chunk has no leading zeros
+        INTEGER_DIGIT_T r = static_cast <INTEGER_DIGIT_T> (rem);
+        for(integer::REP_SIZE_T i = 0; (i < per_chunk) && (n || r); i++){
+            if (d == last){
+                return too_large;
+            }
+            *d++ = LOWER_DIGITS[r % b];
+            r = static_cast <INTEGER_DIGIT_T> (r / b);
+        }
+    }
+
+    // zero
+    if (d == out){
+        if (d == last){
+            return too_large;
+        }
+        *d++ = '0';
+    }
+
+    std::reverse(out, d);
+
+    const integer::to_chars_result result = {d, std::errc()};
+    return result;
+}
+
+integer::from_chars_result from_chars(const char * first, const char * last, integer & value, const int & base){
+    const integer::from_chars_result invalid = {first, std::errc::invalid_argument};
+
+    if ((((base < 2) || (base > 16)) && (base != 256)) || (first == last)){
+        return invalid;
+    }
+
+    // every character is a byte
+    if (base == 256){
+        const std::size_t count = last - first;
+        value._value.clear();
+        value._value.resize((count + integer::OCTETS - 1) / integer::OCTETS);
+        for(std::size_t i = 0; i < count; i++){
+            value._value[i / integer::OCTETS] |= static_cast <INTEGER_DIGIT_T> (static_cast <INTEGER_DIGIT_T> (static_cast <unsigned char> (last[-1 - static_cast <std::ptrdiff_t> (i)])) << ((i % integer::OCTETS) << 3));
+        }
+        value._sign = integer::POSITIVE;
+        value.trim();
+
+        const integer::from_chars_result result = {last, std::errc()};
+        return result;
+    }
+
+    const bool negative = (*first == '-');
+    const char * start = first + negative;
+
+    // find the end of the digits
+    const uint8_t * values = digit_values();
+    const char * end = start;
+    while ((end != last) && (values[static_cast <unsigned char> (*end)] < base)){
+        end++;
+    }
+
+    if (end == start){
+        return invalid;
+    }
+
+    if (!(base & (base - 1))){
+        unsigned int shift = 1;
+        while ((1 << shift) < base){
+            shift++;
+        }
+        value.from_pow2(start, end, shift, values);
+    }
+    else if ((static_cast <std::size_t> (end - start) / integer::chunk_digits(static_cast <INTEGER_DIGIT_T> (base)) * integer::BITS) >= integer::from_chars_threshold){
+        // large inputs are combined in halves like the string constructor
+        // does, which allocates, but avoids taking quadratic time
+        const INTEGER_DIGIT_T b = static_cast <INTEGER_DIGIT_T> (base);
+        const integer::REP_SIZE_T per_chunk = integer::chunk_digits(b);
+        std::vector <INTEGER_DIGIT_T> chunks;
+        chunks.reserve((end - start) / per_chunk);
+        INTEGER_DIGIT_T tail = 0;
+        integer::REP_SIZE_T tail_digits = 0;
+        for(const char * c = start; c != end; c++){
+            tail = static_cast <INTEGER_DIGIT_T> (tail * b + values[static_cast <unsigned char> (*c)]);
+            if (++tail_digits == per_chunk){
+                chunks.push_back(tail);
+                tail = 0;
+                tail_digits = 0;
+            }
+        }
+        value = integer::from_chunks(chunks, integer(base), per_chunk, tail, tail_digits);
+    }
+    else{
+        // at most 4 bits per character, and room for a carry
+        value._value.clear();
+        value._value.reserve(((end - start) * 4 + integer::BITS - 1) / integer::BITS + 1);
+        value._sign = integer::POSITIVE;
+
+        const INTEGER_DIGIT_T b = static_cast <INTEGER_DIGIT_T> (base);
+        const integer::REP_SIZE_T per_chunk = integer::chunk_digits(b);
+        for(const char * c = start; c != end;){
+            INTEGER_DIGIT_T chunk = 0;
+            INTEGER_DIGIT_T scale = 1;
+            for(integer::REP_SIZE_T i = 0; (i < per_chunk) && (c != end); i++, c++){
+                chunk = static_cast <INTEGER_DIGIT_T> (chunk * b + values[static_cast <unsigned char> (*c)]);
+                scale = static_cast <INTEGER_DIGIT_T> (scale * b);
+            }
+            value.mult_digit(scale, integer::POSITIVE);
+            value += chunk;
+        }
+    }
+
+    value._sign = negative?integer::NEGATIVE:integer::POSITIVE;
+    value.trim();
+
+    const integer::from_chars_result result = {end, std::errc()};
+    return result;
+}
+
+void import_bytes(integer & value, const void * data, const std::size_t & count, const std::size_t & size, const int & endian, const int & order){
+    const byte_layout layout(count, size, endian, order);
+    const std::size_t bytes = count * size;
+    const unsigned char * in = static_cast <const unsigned char *> (data);
+
+    value._value.clear();
+    value._value.resize((bytes + integer::OCTETS - 1) / integer::OCTETS);
+    value._sign = integer::POSITIVE;
+
+    if (layout.native()){
+        if (bytes){
+            std::memcpy(&value._value[0], in, bytes);
+        }
+    }
+    else{
+        for(std::size_t i = 0; i < bytes; i++){
+            value._value[i / integer::OCTETS] |= static_cast <INTEGER_DIGIT_T> (static_cast <INTEGER_DIGIT_T> (in[layout(i)]) << ((i % integer::OCTETS) << 3));
+        }
+    }
+
+    value.trim();
+}
+
+std::size_t export_bytes_length(const integer & value, const std::size_t & size){
+    if (!size){
+        throw std::runtime_error("Error: Word size must be positive");
+    }
+    return (((value.bit_count() + 7) >> 3) + size - 1) / size;
+}
+
+std::size_t export_bytes(void * data, const integer & value, const std::size_t & size, const int & endian, const int & order){
+    const std::size_t count = export_bytes_length(value, size);
+    const byte_layout layout(count, size, endian, order);
+    const std::size_t bytes = count * size;
+    const std::size_t available = std::min(bytes, value._value.size() * integer::OCTETS);
+    unsigned char * out = static_cast <unsigned char *> (data);
+
+    if (layout.native()){
+        if (bytes){
+            std::memcpy(out, &value._value[0], available);
+            std::memset(out + available, 0, bytes - available);
+        }
+    }
+    else{
+        for(std::size_t i = 0; i < bytes; i++){
+            out[layout(i)] = (i < available)?static_cast <unsigned char> (value._value[i / integer::OCTETS] >> ((i % integer::OCTETS) << 3)):0;
+        }
+    }
+
+    return count;
+}
+
+std::size_t integer::varint_length(uint64_t value){
+    std::size_t length = 1;
+    while (value > 0x7f){
+        value >>= 7;
+        length++;
+    }
+    return length;
+}
+
+std::size_t integer::serial_header(uint64_t & header) const {
+    const REP_SIZE_T bits = bit_count();
+    const std::size_t count = (bits + 7) >> 3;
+    const uint64_t sign = (_sign == NEGATIVE);
+
+    header = (static_cast <uint64_t> (count) << 2) | sign;
+
+    // small magnitudes fit in the header itself
+    if (bits <= 62){
+        uint64_t magnitude = 0;
+        for(REP_SIZE_T i = 0; i < _value.size(); i++){
+            magnitude |= static_cast <uint64_t> (_value[i]) << (i * BITS);
+        }
+
+        const uint64_t small = (magnitude << 2) | 2 | sign;
+        if (varint_length(small) <= varint_length(header) + count){
+            header = small;
+            return 0;
+        }
+    }
+
+    return count;
+}
+
+std::size_t serialized_size(const integer & value){
+    uint64_t header = 0;
+    const std::size_t count = value.serial_header(header);
+    return integer::varint_length(header) + count;
+}
+
 integer abs(const integer & value){
     return (value.sign() == integer::POSITIVE)?value:-value;
 }
+
+unsigned int pow_window(const integer::REP_SIZE_T & bits){
+    // crossovers where the table of odd powers
+    // costs less than the multiplications it saves
+    if (bits > 671){
+        return 6;
+    }
+    if (bits > 239){
+        return 5;
+    }
+    if (bits > 79){
+        return 4;
+    }
+    if (bits > 23){
+        return 3;
+    }
+    return 1;
+}
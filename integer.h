@@ -22,51 +22,462 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 
-#include <cmath> //For fft sin, cos, M_PI, and floor
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
-#include <deque>
+#include <cstring>
+#include <initializer_list>
 #include <iostream>
+#include <iterator>
 #include <limits>
+#include <memory>
+#include <new>
 #include <stdexcept>
+#include <system_error>
 #include <type_traits>
+#include <vector>
 
 #include <sstream>
 
-#ifndef M_PI
-#define M_PI 3.14159265359
-#endif
-
 #ifndef __INTEGER__
 #define __INTEGER__
 
+// Digits (limbs) default to the widest type whose product
+// still fits in a native double width type
+#if !defined(INTEGER_DIGIT_T) && !defined(INTEGER_DOUBLE_DIGIT_T)
+#if defined(__SIZEOF_INT128__)
+#define INTEGER_DIGIT_T        uint64_t
+#define INTEGER_DOUBLE_DIGIT_T __uint128_t
+#else
+#define INTEGER_DIGIT_T        uint32_t
+#define INTEGER_DOUBLE_DIGIT_T uint64_t
+#endif
+#endif
+
 #ifndef INTEGER_DIGIT_T
-#define INTEGER_DIGIT_T        uint8_t
+#define INTEGER_DIGIT_T        uint64_t
 #endif
 
 #ifndef INTEGER_DOUBLE_DIGIT_T
-#define INTEGER_DOUBLE_DIGIT_T uint64_t
+#define INTEGER_DOUBLE_DIGIT_T __uint128_t
 #endif
 
 // INTEGET_DIGIT_T and INTEGER_DOUBLE_DIGIT_T
 // should be unsigned integers
+// (std::is_unsigned is false for __uint128_t in strict ANSI mode)
 static_assert(std::is_unsigned <INTEGER_DIGIT_T>::value &&
-              std::is_unsigned <INTEGER_DOUBLE_DIGIT_T>::value
+              (static_cast <INTEGER_DOUBLE_DIGIT_T> (-1) > 0)
               , "Internal types must be unsigned integers");
 
 // INTEGER_DOUBLE_DIGIT_T should be at least 2 times the size of INTEGER_DIGIT_T
 static_assert((2 * sizeof(INTEGER_DIGIT_T)) <= sizeof(INTEGER_DOUBLE_DIGIT_T)
               , "INTEGER_DOUBLE_DIGIT_T should be at least twice the size of INTEGER_DIGIT_T");
 
+// Number of bits that are stored inside of an integer
+// object before the digits are moved onto the heap
+#ifndef INTEGER_INLINE_BITS
+#define INTEGER_INLINE_BITS 128
+#endif
+
+// Default multiplication algorithm crossovers, in bits of the
+// smaller operand. Products smaller than INTEGER_KARATSUBA_THRESHOLD
+// use long multiplication, and products at least as large as
+// INTEGER_NTT_THRESHOLD use the NTT. Karatsuba, Toom-3 and Toom-4
+// are used in between. All of them can also be changed at runtime
+// through the integer::*_threshold variables.
+#ifndef INTEGER_KARATSUBA_THRESHOLD
+#define INTEGER_KARATSUBA_THRESHOLD 2048
+#endif
+
+#ifndef INTEGER_TOOM3_THRESHOLD
+#define INTEGER_TOOM3_THRESHOLD 16384
+#endif
+
+#ifndef INTEGER_TOOM4_THRESHOLD
+#define INTEGER_TOOM4_THRESHOLD 131072
+#endif
+
+#ifndef INTEGER_NTT_THRESHOLD
+#define INTEGER_NTT_THRESHOLD 393216
+#endif
+
+// Default division algorithm crossover, in bits of the divisor.
+// Smaller divisors use long division, and divisors at least as large
+// as INTEGER_BURNIKEL_ZIEGLER_THRESHOLD use recursive division. It can
+// also be changed at runtime through integer::burnikel_ziegler_threshold.
+#ifndef INTEGER_BURNIKEL_ZIEGLER_THRESHOLD
+#define INTEGER_BURNIKEL_ZIEGLER_THRESHOLD 8192
+#endif
+
+// Divisors of at least INTEGER_NEWTON_THRESHOLD bits are divided by
+// multiplying with a reciprocal found by Newton iteration instead.
+// It can also be changed at runtime through integer::newton_threshold.
+#ifndef INTEGER_NEWTON_THRESHOLD
+#define INTEGER_NEWTON_THRESHOLD 4194304
+#endif
+
+// Montgomery reduction (REDC) clears one digit at a time for moduli below
+// INTEGER_REDC_THRESHOLD bits, and uses two multiplications for larger ones.
+// It can also be changed at runtime through integer::redc_threshold.
+#ifndef INTEGER_REDC_THRESHOLD
+#define INTEGER_REDC_THRESHOLD 131072
+#endif
+
+// from_chars reads inputs in bases that are not powers of 2 one chunk at a
+// time in place below INTEGER_FROM_CHARS_THRESHOLD bits, and combines the
+// chunks in halves at or above it. It can also be changed at runtime
+// through integer::from_chars_threshold.
+#ifndef INTEGER_FROM_CHARS_THRESHOLD
+#define INTEGER_FROM_CHARS_THRESHOLD 262144
+#endif
+
+// Contiguous container with the same interface as std::vector
+// (for the parts that are used) that holds up to N values inside
+// of the object itself. Memory is only allocated once the size
+// grows past N, so small values never touch the heap. Heap memory
+// comes from Allocator, which has to be stateless.
+template <typename T, std::size_t N, typename Allocator = std::allocator <T> >
+class small_vector{
+    static_assert(std::is_trivial <T>::value
+                  , "small_vector only holds trivial types");
+
+    public:
+        typedef T                                      value_type;
+        typedef std::size_t                            size_type;
+        typedef T &                                    reference;
+        typedef const T &                              const_reference;
+        typedef T *                                    pointer;
+        typedef const T *                              const_pointer;
+        typedef T *                                    iterator;
+        typedef const T *                              const_iterator;
+        typedef std::reverse_iterator <iterator>       reverse_iterator;
+        typedef std::reverse_iterator <const_iterator> const_reverse_iterator;
+        typedef Allocator                              allocator_type;
+
+        static constexpr size_type inline_capacity = N;
+
+    private:
+        T *       _data;        // points to either _inline or heap memory
+        size_type _size;
+        size_type _capacity;
+        T         _inline[N];
+
+        bool on_heap() const {
+            return _data != _inline;
+        }
+
+        // move the values into a buffer that can hold at least n values
+        void reallocate(size_type n){
+            T * data = Allocator().allocate(n);
+            if (_size){
+                std::memcpy(data, _data, _size * sizeof(T));
+            }
+            release();
+            _data = data;
+            _capacity = n;
+        }
+
+        // give back heap memory
+        void release(){
+            if (on_heap()){
+                Allocator().deallocate(_data, _capacity);
+            }
+        }
+
+        // make sure there is space for n values, growing geometrically
+        void grow(size_type n){
+            if (n > _capacity){
+                reallocate(std::max(n, _capacity + (_capacity >> 1)));
+            }
+        }
+
+        // take the contents of rhs and leave it empty
+        void steal(small_vector & rhs){
+            if (rhs.on_heap()){
+                _data     = rhs._data;
+                _capacity = rhs._capacity;
+            }
+            else{
+                _data     = _inline;
+                _capacity = N;
+                std::memcpy(_inline, rhs._inline, rhs._size * sizeof(T));
+            }
+            _size = rhs._size;
+
+            rhs._data     = rhs._inline;
+            rhs._size     = 0;
+            rhs._capacity = N;
+        }
+
+    public:
+        small_vector() :
+            _data(_inline),
+            _size(0),
+            _capacity(N)
+        {}
+
+        explicit small_vector(const size_type n, const T & value = T()) :
+            small_vector()
+        {
+            resize(n, value);
+        }
+
+        template <typename Iterator, typename = typename std::enable_if <!std::is_integral <Iterator>::value>::type>
+        small_vector(Iterator first, Iterator last) :
+            small_vector()
+        {
+            assign(first, last);
+        }
+
+        small_vector(std::initializer_list <T> list) :
+            small_vector(list.begin(), list.end())
+        {}
+
+        small_vector(const small_vector & rhs) :
+            small_vector(rhs.begin(), rhs.end())
+        {}
+
+        small_vector(small_vector && rhs) :
+            small_vector()
+        {
+            steal(rhs);
+        }
+
+        ~small_vector(){
+            release();
+        }
+
+        small_vector & operator=(const small_vector & rhs){
+            if (this != &rhs){
+                assign(rhs.begin(), rhs.end());
+            }
+            return *this;
+        }
+
+        small_vector & operator=(small_vector && rhs){
+            if (this != &rhs){
+                release();
+                steal(rhs);
+            }
+            return *this;
+        }
+
+        small_vector & operator=(std::initializer_list <T> list){
+            assign(list.begin(), list.end());
+            return *this;
+        }
+
+        // existing capacity is reused
+        template <typename Iterator>
+        void assign(Iterator first, Iterator last){
+            clear();
+            reserve(std::distance(first, last));
+            for(; first != last; first++){
+                _data[_size++] = *first;
+            }
+        }
+
+        size_type size()     const { return _size;       }
+        size_type capacity() const { return _capacity;   }
+        bool      empty()    const { return !_size;      }
+
+        T *       data()           { return _data;       }
+        const T * data()     const { return _data;       }
+
+        iterator               begin()        { return _data;                           }
+        const_iterator         begin()  const { return _data;                           }
+        iterator               end()          { return _data + _size;                   }
+        const_iterator         end()    const { return _data + _size;                   }
+        reverse_iterator       rbegin()       { return reverse_iterator(end());         }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end());   }
+        reverse_iterator       rend()         { return reverse_iterator(begin());       }
+        const_reverse_iterator rend()   const { return const_reverse_iterator(begin()); }
+
+        T &       operator[](const size_type i)       { return _data[i];         }
+        const T & operator[](const size_type i) const { return _data[i];         }
+        T &       front()                             { return _data[0];         }
+        const T & front()                       const { return _data[0];         }
+        T &       back()                              { return _data[_size - 1]; }
+        const T & back()                        const { return _data[_size - 1]; }
+
+        void reserve(const size_type n){
+            if (n > _capacity){
+                reallocate(n);
+            }
+        }
+
+        void resize(const size_type n, const T & value = T()){
+            grow(n);
+            for(size_type i = _size; i < n; i++){
+                _data[i] = value;
+            }
+            _size = n;
+        }
+
+        void push_back(const T & value){
+            grow(_size + 1);
+            _data[_size++] = value;
+        }
+
+        void pop_back(){
+            _size--;
+        }
+
+        void clear(){
+            _size = 0;
+        }
+
+        void swap(small_vector & rhs){
+            small_vector tmp(std::move(rhs));
+            rhs = std::move(*this);
+            *this = std::move(tmp);
+        }
+};
+
+template <typename T, std::size_t N, typename Allocator>
+constexpr typename small_vector <T, N, Allocator>::size_type small_vector <T, N, Allocator>::inline_capacity;
+
+template <typename T, std::size_t N, typename Allocator>
+bool operator==(const small_vector <T, N, Allocator> & lhs, const small_vector <T, N, Allocator> & rhs){
+    return (lhs.size() == rhs.size()) && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename T, std::size_t N, typename Allocator>
+bool operator!=(const small_vector <T, N, Allocator> & lhs, const small_vector <T, N, Allocator> & rhs){
+    return !(lhs == rhs);
+}
+
+// Source of the memory that integers use for digits that do not fit
+// inside of the object. Each thread has a current resource (operator new
+// when there is none), which can be changed for a block of code with
+// integer_memory_scope, for example to give each request its own arena
+// or each thread its own pool. Values remember where their memory came
+// from and give it back there, even when they are destroyed on another
+// thread or after the scope has ended, so a resource has to outlive every
+// value that allocated from it.
+class integer_memory_resource{
+    public:
+        virtual ~integer_memory_resource();
+
+        // memory aligned for any type
+        virtual void * allocate(const std::size_t & bytes) = 0;
+        virtual void deallocate(void * ptr, const std::size_t & bytes) = 0;
+
+        // resource used by the calling thread (nullptr for operator new)
+        static integer_memory_resource * current();
+
+        // sets the resource used by the calling thread and returns the previous one
+        static integer_memory_resource * current(integer_memory_resource * resource);
+};
+
+// Makes integers on the calling thread allocate from a resource
+// until the end of the scope
+class integer_memory_scope{
+    private:
+        integer_memory_resource * _previous;
+
+    public:
+        explicit integer_memory_scope(integer_memory_resource * resource);
+        ~integer_memory_scope();
+
+        integer_memory_scope(const integer_memory_scope &) = delete;
+        integer_memory_scope & operator=(const integer_memory_scope &) = delete;
+};
+
+// Arena that hands out memory from a buffer, and then from blocks from
+// operator new that double in size. Deallocating does nothing, and all of
+// the memory is reclaimed at once by release() or the destructor, which
+// suits values that are thrown away together, like the temporaries of one
+// request. It is not thread safe.
+class integer_monotonic_resource : public integer_memory_resource{
+    private:
+        char *      _buffer;    // initial buffer, if any
+        std::size_t _size;      // size of the initial buffer
+        char *      _current;   // next free byte
+        std::size_t _left;      // bytes left after _current
+        std::size_t _next;      // size of the next block
+        void *      _blocks;    // blocks from operator new, each starting with a pointer to the previous one
+
+    public:
+        explicit integer_monotonic_resource(const std::size_t & initial = 4096);
+        integer_monotonic_resource(void * buffer, const std::size_t & size);
+        ~integer_monotonic_resource();
+
+        integer_monotonic_resource(const integer_monotonic_resource &) = delete;
+        integer_monotonic_resource & operator=(const integer_monotonic_resource &) = delete;
+
+        // frees every block and starts over from the initial buffer
+        void release();
+
+        void * allocate(const std::size_t & bytes);
+        void deallocate(void * ptr, const std::size_t & bytes);
+};
+
+// Stateless allocator for the digits of integers that draws from the
+// calling thread's integer_memory_resource. The resource is stored in
+// front of each block so that the block goes back to where it came from.
+template <typename T>
+struct integer_allocator{
+    typedef T value_type;
+
+    // keeps the values after the resource pointer aligned
+    static constexpr std::size_t HEADER = (alignof(std::max_align_t) > sizeof(integer_memory_resource *))?alignof(std::max_align_t):sizeof(integer_memory_resource *);
+
+    integer_allocator() {}
+
+    template <typename U>
+    integer_allocator(const integer_allocator <U> &) {}
+
+    T * allocate(const std::size_t n){
+        integer_memory_resource * resource = integer_memory_resource::current();
+        const std::size_t bytes = HEADER + n * sizeof(T);
+        void * block = resource?resource -> allocate(bytes):(::operator new(bytes));
+        *static_cast <integer_memory_resource **> (block) = resource;
+        return reinterpret_cast <T *> (static_cast <char *> (block) + HEADER);
+    }
+
+    void deallocate(T * ptr, const std::size_t n){
+        void * block = reinterpret_cast <char *> (ptr) - HEADER;
+        integer_memory_resource * resource = *static_cast <integer_memory_resource **> (block);
+        if (resource){
+            resource -> deallocate(block, HEADER + n * sizeof(T));
+        }
+        else{
+            ::operator delete(block);
+        }
+    }
+};
+
+template <typename T>
+constexpr std::size_t integer_allocator <T>::HEADER;
+
+template <typename T, typename U>
+bool operator==(const integer_allocator <T> &, const integer_allocator <U> &){
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const integer_allocator <T> &, const integer_allocator <U> &){
+    return false;
+}
+
+// views of digits stored outside of an integer (defined below)
+class integer_view;
+class integer_span;
+
 class integer{
     public:
-        typedef std::deque <INTEGER_DIGIT_T> REP;                                                 // internal representation of values
-        typedef REP::size_type               REP_SIZE_T;                                          // size type of internal representation
+        typedef small_vector <INTEGER_DIGIT_T,
+                              ((INTEGER_INLINE_BITS / (sizeof(INTEGER_DIGIT_T) << 3)) > 0)?
+                              (INTEGER_INLINE_BITS / (sizeof(INTEGER_DIGIT_T) << 3)):1,
+                              integer_allocator <INTEGER_DIGIT_T> > REP;                     // internal representation of values (little-endian digits)
+        typedef REP::size_type                REP_SIZE_T;                                         // size type of internal representation
 
     private:
         static constexpr INTEGER_DIGIT_T NEG1     = std::numeric_limits <INTEGER_DIGIT_T>::max(); // value with all bits ON - will only work for unsigned integer types
         static constexpr std::size_t     OCTETS   = sizeof(INTEGER_DIGIT_T);                      // number of octets per INTEGER_DIGIT_T
         static constexpr std::size_t     BITS     = OCTETS << 3;                                  // number of bits per INTEGER_DIGIT_T; hardcode this if INTEGER_DIGIT_T is not standard int type
-        static constexpr INTEGER_DIGIT_T HIGH_BIT = 1 << (BITS - 1);                              // highest bit of INTEGER_DIGIT_T (uint8_t -> 128)
+        static constexpr INTEGER_DIGIT_T HIGH_BIT = static_cast <INTEGER_DIGIT_T> (1) << (BITS - 1); // highest bit of INTEGER_DIGIT_T (uint8_t -> 128)
 
     public:
         typedef bool Sign;
@@ -86,34 +497,66 @@ class integer{
             _value.clear();
             _sign = POSITIVE;
 
+            // widen first so that the most negative value can be negated
+            // (types wider than uintmax_t, like __int128, use their own unsigned type)
+            typedef typename std::conditional <(sizeof(Z) > sizeof(uintmax_t)),
+                                               std::make_unsigned <Z>,
+                                               std::common_type <uintmax_t> >::type::type Magnitude;
+            Magnitude mag = static_cast <Magnitude> (val);
+
             // make positive
-            if (std::is_signed <Z>::value && (val < 0)){
+            if (std::is_signed <Z>::value && (val < static_cast <Z> (0))){
                 _sign = NEGATIVE;
-                val = -val; // treat as positive even if top bit is still set
+                mag = -mag;
             }
 
-            // keep this here just in case value is sign extended
-            for(std::size_t d = std::max(sizeof(Z) / OCTETS, (std::size_t) 1); d > 0; d--){
-                _value.push_front(val & NEG1);
-                val >>= BITS;
+            // least significant digit first
+            while (mag){
+                _value.push_back(static_cast <INTEGER_DIGIT_T> (mag & NEG1));
+                mag >>= BITS - 1;   // two shifts so that BITS == width of mag is not undefined
+                mag >>= 1;
             }
 
-            return trim();
+            return *this;
+        }
+
+        // split a builtin integral value into its sign and absolute value
+        // returns false if the absolute value does not fit in a single digit
+        template <typename Z>
+        static bool split(const Z & val, Sign & sign, INTEGER_DIGIT_T & digit){
+            if (sizeof(Z) > sizeof(uintmax_t)){
+                return false;
+            }
+            uintmax_t mag = static_cast <uintmax_t> (val);
+            sign = POSITIVE;
+            if (std::is_signed <Z>::value && (val < static_cast <Z> (0))){
+                sign = NEGATIVE;
+                mag = -mag;
+            }
+            digit = static_cast <INTEGER_DIGIT_T> (mag);
+            return mag <= NEG1;
         }
 
-        // remove 0 digits from top of deque to save memory
+        // remove 0 digits from the top of the value to save memory
         integer & trim();
 
+        // number of bits in the absolute value
+        REP_SIZE_T bit_count() const;
+
     public:
         // Constructors
         integer();
         integer(const integer & rhs);
         integer(integer && rhs);
         integer(const REP & rhs, const Sign & sign = POSITIVE);
+        integer(REP && rhs, const Sign & sign = POSITIVE);
 
         // Special boolean constructor
         integer(const bool & b);
 
+        // Copy of a value viewed by an integer_view
+        explicit integer(const integer_view & view);
+
         // Constructors for integral input
         template <typename Z>
         integer(const Z & val){
@@ -129,18 +572,73 @@ class integer{
         integer(const std::string & val, const integer & base);
 
         // Use this to construct integers with other types that have pointers/iterators to their beginning and end
-        // all inputs are treated as positive values
+        // all inputs are treated as positive values, and each one must be a digit in the given base
+        // chars are read as unsigned chars so that strings can be read in base 256
         template <typename Iterator> integer(Iterator start, const Iterator & end, const integer & base) : integer()
         {
             if (base < 2){
                 throw std::runtime_error("Error: Cannot convert from base " + base.str(10));
             }
 
+            typedef typename std::iterator_traits <Iterator>::value_type value_type;
+            typedef typename std::conditional <std::is_same <value_type, char>::value, unsigned char, value_type>::type digit_type;
+
+            // as many input digits as fit are packed into each chunk, and the
+            // chunks are combined with a few large multiplications at the end
+            // bases that do not fit in a digit get one input digit per chunk
+            const INTEGER_DIGIT_T b = (base._value.size() == 1)?base._value[0]:0;
+            const REP_SIZE_T per_chunk = chunk_digits(b);
+            std::vector <integer> large_chunks;
+            std::vector <INTEGER_DIGIT_T> chunks;
+            INTEGER_DIGIT_T tail = 0;
+            REP_SIZE_T tail_digits = 0;
             for(; start != end; start++){
-                *this = (*this * base) | *start;
+                const integer d(static_cast <digit_type> (*start));
+                if ((d._sign == NEGATIVE) || (d >= base)){
+                    throw std::runtime_error("Error: Not a digit in base " + base.str(10) + ": " + d.str(10));
+                }
+
+                if (!b){
+                    large_chunks.push_back(d);
+                    continue;
+                }
+
+                tail = static_cast <INTEGER_DIGIT_T> (tail * b + (d._value.empty()?0:d._value[0]));
+                if (++tail_digits == per_chunk){
+                    chunks.push_back(tail);
+                    tail = 0;
+                    tail_digits = 0;
+                }
+            }
+
+            if (b){
+                *this = from_chunks(chunks, base, per_chunk, tail, tail_digits);
+            }
+            else{
+                *this = from_chunks(large_chunks, base, per_chunk, tail, tail_digits);
             }
         }
 
+    private:
+        // number of digits in the given base that fit in one digit (at least 1)
+        // base^chunk_digits(base) - 1 is the largest value that a chunk can hold
+        static REP_SIZE_T chunk_digits(const INTEGER_DIGIT_T & base);
+
+        // combines chunks that each hold per_chunk digits in the given base,
+        // most significant first, followed by tail_digits more digits in tail
+        // Chunks are either digits or, for bases that do not fit in a digit,
+        // integers. Large runs of chunks are split in half and joined with
+        // powers of base^per_chunk, so building the value costs a few
+        // multiplications instead of one per input digit. Chunks in bases
+        // 2, 4, 8, and 16 are placed next to each other without arithmetic.
+        // (defined in integer.cpp for both kinds of chunks)
+        template <typename Chunk>
+        static integer from_chunks(const std::vector <Chunk> & chunks, const integer & base, const REP_SIZE_T & per_chunk, const INTEGER_DIGIT_T & tail, const REP_SIZE_T & tail_digits);
+
+        // chunks[first, first + count) in base powers[0], where powers[i] = powers[0]^(2^i)
+        template <typename Chunk>
+        static integer combine_chunks(const std::vector <Chunk> & chunks, const std::size_t & first, const std::size_t & count, const std::vector <integer> & powers);
+
     public:
         //  RHS input args only
 
@@ -166,6 +664,17 @@ class integer{
         operator int32_t()  const;
         operator int64_t()  const;
 
+    private:
+        // two's complement of the absolute value in b bits, written into
+        // the (b + BITS - 1) / BITS digits of out, which may be value
+        static void twos_complement(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * value, const REP_SIZE_T & size, const REP_SIZE_T & b);
+
+        // applies op to each digit of the two's complement forms
+        // of lhs and rhs, where negative means that the result is
+        template <typename Op>
+        static integer bitwise(const integer & lhs, const integer & rhs, const Op & op, const bool & negative);
+
+    public:
         // Bitwise Operators
         integer operator&(const integer & rhs) const;
         template <typename Z>
@@ -217,6 +726,21 @@ class integer{
 
         integer operator~() const;
 
+    private:
+        // in place shifts of the absolute value by a native amount
+        integer & lshift(const REP_SIZE_T & shift);
+        integer & rshift(const REP_SIZE_T & shift);
+
+        // shift amount as a native value
+        template <typename Z>
+        static REP_SIZE_T shift_amount(const Z & shift){
+            if (std::is_signed <Z>::value && (shift < static_cast <Z> (0))){
+                throw std::runtime_error("Error: Negative shift amount");
+            }
+            return static_cast <REP_SIZE_T> (shift);
+        }
+
+    public:
         // Bitshift Operators
         // left bitshift. sign is maintained
         integer operator<<(const integer & shift) const;
@@ -224,7 +748,9 @@ class integer{
         integer operator<<(const Z & rhs)         const {
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return *this << integer(rhs);
+            integer out(*this);
+            out.lshift(shift_amount(rhs));
+            return out;
         }
 
         integer & operator<<=(const integer & shift);
@@ -232,7 +758,7 @@ class integer{
         integer & operator<<=(const Z & rhs){
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return *this <<= integer(rhs);
+            return lshift(shift_amount(rhs));
         }
 
         // right bitshift. sign is maintained
@@ -241,7 +767,9 @@ class integer{
         integer operator>>(const Z & rhs)         const {
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return *this >> integer(rhs);
+            integer out(*this);
+            out.rshift(shift_amount(rhs));
+            return out;
         }
 
         integer & operator>>=(const integer & shift);
@@ -249,7 +777,7 @@ class integer{
         integer & operator>>=(const Z & rhs){
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return *this >>= integer(rhs);
+            return rshift(shift_amount(rhs));
         }
 
         // Logical Operators
@@ -258,65 +786,110 @@ class integer{
         // Comparison Operators
         bool operator==(const integer & rhs) const;
         template <typename Z>
-        integer operator==(const Z & rhs)    const {
+        bool operator==(const Z & rhs)       const {
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return (*this == integer(rhs));
+            Sign sign;
+            INTEGER_DIGIT_T digit;
+            if (!split(rhs, sign, digit)){
+                return (*this == integer(rhs));
+            }
+            return compare(sign, digit) == 0;
         }
 
         bool operator!=(const integer & rhs) const;
         template <typename Z>
-        integer operator!=(const Z & rhs)    const {
+        bool operator!=(const Z & rhs)       const {
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return (*this != integer(rhs));
+            Sign sign;
+            INTEGER_DIGIT_T digit;
+            if (!split(rhs, sign, digit)){
+                return (*this != integer(rhs));
+            }
+            return compare(sign, digit) != 0;
         }
 
     private:
+        // compare absolute values
+        // returns a negative value, 0, or a positive value if lhs is less than, equal to, or greater than rhs
+        static int compare(const INTEGER_DIGIT_T * lhs, const REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const REP_SIZE_T & rsize);
+
+        // compare against a single digit value with the given sign
+        int compare(const Sign & sign, const INTEGER_DIGIT_T & digit) const;
+
         // operator> not considering signs
-        bool gt(const integer & lhs, const integer & rhs) const;
+        static bool gt(const integer_view & lhs, const integer_view & rhs);
 
     public:
         bool operator>(const integer & rhs) const;
         template <typename Z>
-        integer operator>(const Z & rhs)    const {
+        bool operator>(const Z & rhs)       const {
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return (*this > integer(rhs));
+            Sign sign;
+            INTEGER_DIGIT_T digit;
+            if (!split(rhs, sign, digit)){
+                return (*this > integer(rhs));
+            }
+            return compare(sign, digit) > 0;
         }
 
         bool operator>=(const integer & rhs) const;
         template <typename Z>
-        integer operator>=(const Z & rhs)    const {
+        bool operator>=(const Z & rhs)       const {
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return (*this >= integer(rhs));
+            Sign sign;
+            INTEGER_DIGIT_T digit;
+            if (!split(rhs, sign, digit)){
+                return (*this >= integer(rhs));
+            }
+            return compare(sign, digit) >= 0;
         }
 
     private:
         // operator< not considering signs
-        bool lt(const integer & lhs, const integer & rhs) const;
+        static bool lt(const integer_view & lhs, const integer_view & rhs);
 
     public:
         bool operator<(const integer & rhs) const;
         template <typename Z>
-        integer operator<(const Z & rhs)    const {
+        bool operator<(const Z & rhs)       const {
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return (*this < integer(rhs));
+            Sign sign;
+            INTEGER_DIGIT_T digit;
+            if (!split(rhs, sign, digit)){
+                return (*this < integer(rhs));
+            }
+            return compare(sign, digit) < 0;
         }
 
         bool operator<=(const integer & rhs) const;
         template <typename Z>
-        integer operator<=(const Z & rhs)    const {
+        bool operator<=(const Z & rhs)       const {
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return (*this <= integer(rhs));
+            Sign sign;
+            INTEGER_DIGIT_T digit;
+            if (!split(rhs, sign, digit)){
+                return (*this <= integer(rhs));
+            }
+            return compare(sign, digit) <= 0;
         }
 
     private:
         // Arithmetic Operators
-        integer add(const integer & lhs, const integer & rhs) const;
+        // The digit kernels work in place on the absolute value in lhs.
+        // Existing capacity is reused and only grown when the result needs
+        // more room. rhs may point into lhs.
+
+        // lhs += rhs
+        static void add(REP & lhs, const INTEGER_DIGIT_T * rhs, const REP_SIZE_T & rsize);
+
+        // *this += rhs, where rhs has the given sign
+        integer & add_signed(const INTEGER_DIGIT_T * rhs, const REP_SIZE_T & rsize, const Sign & rsign);
 
     public:
         integer operator+(const integer & rhs) const;
@@ -324,7 +897,9 @@ class integer{
         integer operator+(const Z & rhs)       const {
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return *this + integer(rhs);
+            integer out(*this);
+            out += rhs;
+            return out;
         }
 
         integer & operator+=(const integer & rhs);
@@ -332,28 +907,34 @@ class integer{
         integer & operator+=(const Z & rhs){
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return *this += integer(rhs);
+            Sign sign;
+            INTEGER_DIGIT_T digit;
+            if (!split(rhs, sign, digit)){
+                return *this += integer(rhs);
+            }
+            return add_signed(&digit, digit?1:0, sign);
         }
 
     private:
         // Subtraction as done by hand
-        // lhs must be larger than rhs
-        integer long_sub(const integer & lhs, const integer & rhs) const;
+        // lhs -= rhs, where lhs must be larger than or equal to rhs
+        static void long_sub(REP & lhs, const INTEGER_DIGIT_T * rhs, const REP_SIZE_T & rsize);
+
+        // lhs = rhs - lhs, where rhs must be larger than lhs
+        static void long_rsub(REP & lhs, const INTEGER_DIGIT_T * rhs, const REP_SIZE_T & rsize);
 
         // // Two's Complement Subtraction
         // integer two_comp_sub(const integer & lhs, const integer & rhs) const;
 
-        // subtraction not considering signs
-        // lhs must be larger than rhs
-        integer sub(const integer & lhs, const integer & rhs) const;
-
     public:
         integer operator-(const integer & rhs) const;
         template <typename Z>
         integer operator-(const Z & rhs)       const {
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return *this - integer(rhs);
+            integer out(*this);
+            out -= rhs;
+            return out;
         }
 
         integer & operator-=(const integer & rhs);
@@ -361,7 +942,12 @@ class integer{
         integer & operator-=(const Z & rhs){
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return *this -= integer(rhs);
+            Sign sign;
+            INTEGER_DIGIT_T digit;
+            if (!split(rhs, sign, digit)){
+                return *this -= integer(rhs);
+            }
+            return add_signed(&digit, digit?1:0, !sign);
         }
 
     private:
@@ -374,40 +960,91 @@ class integer{
         // // Recursive Multiplication
         // integer recursive_mult(const integer & lhs, const integer & rhs) const;
 
-        // // Karatsuba Algorithm O(n-log2(3) = n - 1.585)
-        // // The Peasant Multiplication function is needed if Karatsuba is used.
-        // // Thanks to kjo @ stackoverflow for fixing up my original Karatsuba Algorithm implementation
-        // // which I then converted to C++ and made a few changes.
-        // // http://stackoverflow.com/questions/7058838/karatsuba-algorithm-too-much-recursion
-        // integer karatsuba(const integer & lhs, const integer & rhs, integer bm = 0x1000000U) const;
-
-        // // // Toom-Cook multiplication
-        // // // as described at http://en.wikipedia.org/wiki/Toom%E2%80%93Cook_multiplications
-        // // // The peasant function is needed if karatsuba is used.
-        // // // This implementation is a bit weird. In the pointwise Multiplcation step, using
-        // // // operator* and long_mult works, but everything else fails.
-        // // // It's also kind of slow.
-        // // integer toom_cook_3(integer m, integer n, integer bm = 0x1000000U);
-
-        // // Long multiplication
-        // integer long_mult(const integer & lhs, const integer & rhs) const;
-
-        //Private FFT helper function
-        int fft(std::deque<double>& data, bool dir = true) const;
-
-        // FFT-based multiplication
-        //Based on the convolution theorem which states that the Fourier
-        //transform of a convolution is the pointwise product of their
-        //Fourier transforms.
-        integer fft_mult(const integer& lhs, const integer& rhs) const;
+        // out = lhs + rhs and out = lhs - rhs over digit arrays
+        // lsize >= rsize, out has room for lsize digits and may be lhs.
+        // The carry or borrow out of the top digit is returned.
+        static INTEGER_DIGIT_T add(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * lhs, const REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const REP_SIZE_T & rsize);
+        static INTEGER_DIGIT_T sub(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * lhs, const REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const REP_SIZE_T & rsize);
+
+        // Long multiplication
+        // lhs has room for lsize + rsize digits and is multiplied in place,
+        // from the most significant digit down. rhs must not point into lhs.
+        static void long_mult(INTEGER_DIGIT_T * lhs, const REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const REP_SIZE_T & rsize);
+
+        // lowest size digits of lhs * rhs
+        // out has room for size digits and does not overlap lhs or rhs
+        static void long_mult_low(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * lhs, const REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const REP_SIZE_T & rsize, const REP_SIZE_T & size);
+
+        // Long squaring
+        // out has room for 2 * size digits and does not overlap value
+        static void long_sqr(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * value, const REP_SIZE_T & size);
+
+        // Karatsuba multiplication O(n^log2(3) = n^1.585)
+        // out = lhs * rhs, where rsize <= lsize < 2 * rsize
+        static void karatsuba(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * lhs, const REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const REP_SIZE_T & rsize);
+
+        // Toom-Cook multiplication
+        // as described at http://en.wikipedia.org/wiki/Toom%E2%80%93Cook_multiplication
+        // lhs and rhs are split into 3 or 4 pieces that are treated as the
+        // coefficients of polynomials, which are evaluated at 5 or 7 points,
+        // multiplied pointwise, and interpolated back into the product.
+        // The evaluations and the steps of the interpolation are signed
+        // values in spans on the scratch stack.
+        // out = lhs * rhs, where rsize <= lsize < 2 * rsize
+        static void toom_cook_3(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * lhs, const REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const REP_SIZE_T & rsize);
+        static void toom_cook_4(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * lhs, const REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const REP_SIZE_T & rsize);
+
+        // value * rhs, value / rhs, and value >> bits in place for signed values in spans
+        // mul_digit needs room for one more digit above the value, div_exact is
+        // only for values that rhs divides, and shift_right is only for values
+        // whose bottom bits are 0, with bits less than the size of a digit
+        static integer_span mul_digit(const integer_span & value, const INTEGER_DIGIT_T & rhs);
+        static integer_span div_exact(const integer_span & value, const INTEGER_DIGIT_T & rhs);
+        static integer_span shift_right(const integer_span & value, const unsigned int & bits);
+
+        // digits [first, first + count) of a digit array as a value
+        static integer slice(const INTEGER_DIGIT_T * digits, const REP_SIZE_T & size, const REP_SIZE_T & first, const REP_SIZE_T & count);
+
+        // out = sum(coeffs[i] * B^(i * m)), where B is the digit base
+        // and every coefficient is non-negative
+        static void recompose(INTEGER_DIGIT_T * out, const REP_SIZE_T & size, const integer_span * coeffs, const REP_SIZE_T & count, const REP_SIZE_T & m);
+
+        // out = lhs * rhs using the algorithm picked by the size of the smaller value
+        // out has room for lsize + rsize digits and does not overlap lhs or rhs
+        // When lhs and rhs are the same digits, every algorithm squares instead,
+        // which skips the work that would be repeated for the second operand.
+        static void mult(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * lhs, const REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const REP_SIZE_T & rsize);
+
+        // products that fit inside of an integer object are built on the stack
+        static integer mult(const integer_view & lhs, const integer_view & rhs);
+
+        // *this *= rhs, where rhs is a single digit with the given sign
+        integer & mult_digit(const INTEGER_DIGIT_T & rhs, const Sign & rsign);
+
+        // Number theoretic transform multiplication
+        // Based on the convolution theorem which states that the Fourier
+        // transform of a convolution is the pointwise product of their
+        // Fourier transforms. The values are convolved as 64 bit words
+        // modulo three primes and the coefficients are recovered with the
+        // Chinese remainder theorem, so the product is exact at any size.
+        static void ntt_mult(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * lhs, const REP_SIZE_T & lsize, const INTEGER_DIGIT_T * rhs, const REP_SIZE_T & rsize);
 
     public:
+        // Multiplication algorithm crossovers, in bits of the smaller value
+        // (INTEGER_*_THRESHOLD by default)
+        static REP_SIZE_T karatsuba_threshold;
+        static REP_SIZE_T toom3_threshold;
+        static REP_SIZE_T toom4_threshold;
+        static REP_SIZE_T ntt_threshold;
+
         integer operator*(const integer & rhs) const;
         template <typename Z>
         integer operator*(const Z & rhs)       const {
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return *this * integer(rhs);
+            integer out(*this);
+            out *= rhs;
+            return out;
         }
 
         integer & operator*=(const integer & rhs);
@@ -415,27 +1052,112 @@ class integer{
         integer & operator*=(const Z & rhs){
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return *this *= integer(rhs);
+            Sign sign;
+            INTEGER_DIGIT_T digit;
+            if (!split(rhs, sign, digit)){
+                return *this *= integer(rhs);
+            }
+            return mult_digit(digit, sign);
         }
 
+        // *this * *this, which is faster than using operator*
+        // with different objects that have the same value
+        integer sqr() const;
+
     private:
         // // Naive Division: keep subtracting until lhs == 0
         // std::pair <integer, integer> naive_divmod(const integer & lhs, const integer & rhs) const;
 
-        // // Long Division returning both quotient and remainder
-        // std::pair <integer, integer> long_divmod(const integer & lhs, const integer & rhs) const;
-
         // // Recursive Division that returns both the quotient and remainder
         // // Recursion took up way too much memory
         // std::pair <integer, integer> recursive_divmod(const integer & lhs, const integer & rhs) const;
 
-        // Non-Recursive version of above algorithm
-        std::pair <integer, integer> non_recursive_divmod(const integer & lhs, const integer & rhs) const;
+        // Long division (Knuth's Algorithm D)
+        // as described in The Art of Computer Programming, Volume 2, Section 4.3.1
+        // u has usize + 1 digits and v has vsize >= 2 digits, with the top bit of
+        // v set. The usize - vsize + 1 digit quotient is written into q, and the
+        // remainder is left in the bottom vsize digits of u.
+        static void long_div(INTEGER_DIGIT_T * q, INTEGER_DIGIT_T * u, const REP_SIZE_T & usize, const INTEGER_DIGIT_T * v, const REP_SIZE_T & vsize);
+
+        // out = digits << shift over size digits, where shift is less than the
+        // size of a digit and out may be digits
+        // returns the bits shifted out of the top digit
+        static INTEGER_DIGIT_T shift_left(INTEGER_DIGIT_T * out, const INTEGER_DIGIT_T * digits, const REP_SIZE_T & size, const unsigned int & shift);
+
+        // normalizes the values and calls long_div
+        // q has room for lhs.digits() - rhs.digits() + 1 digits and r for rhs.digits() digits
+        static void long_divmod(INTEGER_DIGIT_T * q, INTEGER_DIGIT_T * r, const integer_view & lhs, const integer_view & rhs);
+        static std::pair <integer, integer> long_divmod(const integer_view & lhs, const integer_view & rhs);
+
+        // Burnikel-Ziegler recursive division
+        // as described in "Fast Recursive Division" by Christoph Burnikel and Joachim Ziegler
+        // The divisor is normalized, the dividend is cut into blocks the size of
+        // the divisor, and each block is divided with two half sized divisions.
+        // Most of the work ends up in multiplications, so it runs at a small
+        // constant times the cost of multiplying values the size of the divisor.
+        // Takes the same arguments as long_divmod, and works on normalized
+        // copies of the values on the scratch stack.
+        static void burnikel_ziegler(INTEGER_DIGIT_T * q, INTEGER_DIGIT_T * r, const integer_view & lhs, const integer_view & rhs);
+        static std::pair <integer, integer> burnikel_ziegler(const integer_view & lhs, const integer_view & rhs);
+
+        // q = a / b, with the remainder left in the bottom n digits of a
+        // a has 2n digits, b is a normalized n digit value, the top n digits
+        // of a are less than b, and q has room for n digits
+        static void bz_div_2n_1n(INTEGER_DIGIT_T * q, INTEGER_DIGIT_T * a, const INTEGER_DIGIT_T * b, const REP_SIZE_T & n);
+
+        // the same for a with n + k digits and a k digit quotient, where 0 < k < n
+        // The quotient is estimated by dividing the top 2k digits of a by the
+        // top k digits of b, which is at most 2 too large.
+        static void bz_div_3n_2n(INTEGER_DIGIT_T * q, INTEGER_DIGIT_T * a, const REP_SIZE_T & k, const INTEGER_DIGIT_T * b, const REP_SIZE_T & n);
+
+        // *this /= rhs in place, where rhs is a single digit with the given sign
+        // returns the remainder of the absolute values
+        INTEGER_DIGIT_T div_digit(const INTEGER_DIGIT_T & rhs, const Sign & rsign);
+
+        // q = u / rhs over usize digits, where q may be u
+        // returns the remainder
+        static INTEGER_DIGIT_T div_digit(INTEGER_DIGIT_T * q, const INTEGER_DIGIT_T * u, const REP_SIZE_T & usize, const INTEGER_DIGIT_T & rhs);
+
+        // remainder of the absolute value divided by a single digit
+        INTEGER_DIGIT_T mod_digit(const INTEGER_DIGIT_T & rhs) const;
 
         // division and modulus ignoring signs
         std::pair <integer, integer> dm(const integer & lhs, const integer & rhs) const;
 
+        // reduce with the raw digits
+        friend class barrett_reducer;
+        friend class montgomery_context;
+
+        // compare, multiply, and divide digits stored elsewhere
+        friend class integer_view;
+        friend integer operator*(const integer_view & lhs, const integer_view & rhs);
+        friend std::pair <integer, integer> divmod(const integer_view & lhs, const integer_view & rhs);
+
+        // arithmetic into caller owned digits
+        friend integer_span add (const integer_span & out, const integer_view & lhs, const integer_view & rhs);
+        friend integer_span mult(const integer_span & out, const integer_view & lhs, const integer_view & rhs);
+        friend std::pair <integer_span, integer_span> divmod(const integer_span & quotient, const integer_span & remainder, const integer_view & lhs, const integer_view & rhs);
+        friend integer & add (integer & out, const integer_view & lhs, const integer_view & rhs);
+        friend integer & mult(integer & out, const integer_view & lhs, const integer_view & rhs);
+        friend void divmod(integer & quotient, integer & remainder, const integer_view & lhs, const integer_view & rhs);
+
     public:
+        // Division algorithm crossovers, in bits of the divisor
+        // (INTEGER_BURNIKEL_ZIEGLER_THRESHOLD and INTEGER_NEWTON_THRESHOLD by default)
+        static REP_SIZE_T burnikel_ziegler_threshold;
+        static REP_SIZE_T newton_threshold;
+
+        // Montgomery reduction crossover, in bits of the modulus
+        // (INTEGER_REDC_THRESHOLD by default)
+        static REP_SIZE_T redc_threshold;
+
+        // from_chars crossover, in bits of the input
+        // (INTEGER_FROM_CHARS_THRESHOLD by default)
+        static REP_SIZE_T from_chars_threshold;
+
+        // reusable reciprocal of a divisor (defined below)
+        class reciprocal;
+
         // division and modulus with signs
         std::pair <integer, integer> divmod(const integer & lhs, const integer & rhs) const;
 
@@ -444,7 +1166,9 @@ class integer{
         integer operator/(const Z & rhs)       const {
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return *this / integer(rhs);
+            integer out(*this);
+            out /= rhs;
+            return out;
         }
 
         integer & operator/=(const integer & rhs);
@@ -452,7 +1176,13 @@ class integer{
         integer & operator/=(const Z & rhs){
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return *this /= integer(rhs);
+            Sign sign;
+            INTEGER_DIGIT_T digit;
+            if (!split(rhs, sign, digit)){
+                return *this /= integer(rhs);
+            }
+            div_digit(digit, sign);
+            return *this;
         }
 
         integer operator%(const integer & rhs) const;
@@ -460,7 +1190,14 @@ class integer{
         integer operator%(const Z & rhs)       const {
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return *this % integer(rhs);
+            Sign sign;
+            INTEGER_DIGIT_T digit;
+            if (!split(rhs, sign, digit)){
+                return *this % integer(rhs);
+            }
+            integer out(mod_digit(digit));
+            out._sign = _sign;                  // remainder takes the sign of the dividend
+            return out.trim();
         }
 
         integer & operator%=(const integer & rhs);
@@ -468,7 +1205,15 @@ class integer{
         integer & operator%=(const Z & rhs){
             static_assert(std::is_integral <Z>::value
                           , "Input type must be integral");
-            return *this %= integer(rhs);
+            Sign sign;
+            INTEGER_DIGIT_T digit;
+            if (!split(rhs, sign, digit)){
+                return *this %= integer(rhs);
+            }
+            const Sign s = _sign;
+            *this = mod_digit(digit);
+            _sign = s;                          // remainder takes the sign of the dividend
+            return trim();
         }
 
         // Increment Operator
@@ -514,8 +1259,329 @@ class integer{
 
         // Output _value as a string in bases 2 to 16, and 256
         std::string str(const integer & base = 10, const std::string::size_type & length = 1) const;
+
+        // results of to_chars and from_chars (declared below), which
+        // mean the same things as std::to_chars_result and std::from_chars_result
+        struct to_chars_result{
+            char * ptr;
+            std::errc ec;
+        };
+
+        struct from_chars_result{
+            const char * ptr;
+            std::errc ec;
+        };
+
+    private:
+        // writes the absolute value in bases 2 to 16, most significant digit
+        // first and padded with '0's to width characters, by calling
+        // sink(const char * characters, std::size_t count) with pieces of at
+        // most a few thousand characters, so that the whole string never has
+        // to exist at once. digits holds the characters for 0 to 15.
+        template <typename Sink>
+        void write_digits(Sink & sink, const INTEGER_DIGIT_T & base, const std::size_t & width, const char * digits) const;
+
+        // writes width digits of value in the given base into sink, padded
+        // with '0's. powers[i] = chunk^(2^i), where chunk = base^per_chunk is
+        // the largest power of the base that fits in one digit. Large values
+        // are split in half at the largest power that is not longer than they
+        // are, so the conversion takes O(log n) levels of divisions instead
+        // of one per character.
+        template <typename Sink>
+        static void write_split(Sink & sink, const std::size_t & width, const integer_view & value, const integer_view * powers, REP_SIZE_T level, const INTEGER_DIGIT_T & base, const std::size_t & per_chunk, const char * digits);
+
+        // writes count digits in base 2^shift (2, 4, 8, or 16) of the absolute
+        // value, starting with digit first counting from the least significant,
+        // into [out - count, out) by regrouping the bits, including groups that
+        // straddle two digits
+        void str_pow2(char * out, const std::size_t & first, const std::size_t & count, const unsigned int & shift, const char * digits) const;
+
+        // sets the absolute value from the digits in [first, last) in base
+        // 2^shift, which have already been checked, where values maps each
+        // character to its digit
+        void from_pow2(const char * first, const char * last, const unsigned int & shift, const uint8_t * values);
+
+        // conversions that do not allocate
+        friend std::size_t to_chars_length(const integer & value, const int & base);
+        friend to_chars_result to_chars(char * first, char * last, const integer & value, const int & base);
+        friend from_chars_result from_chars(const char * first, const char * last, integer & value, const int & base);
+
+        // raw byte conversions
+        friend void import_bytes(integer & value, const void * data, const std::size_t & count, const std::size_t & size, const int & endian, const int & order);
+        friend std::size_t export_bytes_length(const integer & value, const std::size_t & size);
+        friend std::size_t export_bytes(void * data, const integer & value, const std::size_t & size, const int & endian, const int & order);
+
+        // binary serialization
+        // returns the header of the serialized value and
+        // the number of bytes of the magnitude that follow it
+        std::size_t serial_header(uint64_t & header) const;
+        static std::size_t varint_length(uint64_t value);
+
+        friend std::size_t serialized_size(const integer & value);
+        template <typename OutputIt> friend OutputIt serialize(const integer & value, OutputIt out);
+        template <typename InputIt> friend InputIt deserialize(InputIt first, InputIt last, integer & value);
+
+        // streaming conversions
+        friend std::ostream & operator<<(std::ostream & stream, const integer & rhs);
+        friend std::istream & operator>>(std::istream & stream, integer & rhs);
+};
+
+// Newton reciprocal division
+// A fixed point reciprocal of the divisor is found by Newton iteration,
+// which costs a few multiplications the size of the divisor. After that,
+// every division by the same divisor only takes two multiplications per
+// block of divisor sized digits and at most two corrections, so one
+// object can be reused to divide any number of values.
+class integer::reciprocal{
+    private:
+        integer _divisor;                       // divisor as given
+        integer _normalized;                    // absolute value of the divisor shifted until the top bit is set
+        integer _inverse;                       // floor(B^(2n) / _normalized) - B^n, where _normalized has n digits
+        unsigned int _shift;                    // number of bits _normalized was shifted by
+
+        // within a few units of floor(2^(2m) / d), where d has exactly m bits
+        // the reciprocal of the top half of d is found first, and one
+        // Newton step doubles its precision
+        static integer newton(const integer & d, const REP_SIZE_T & m);
+
+        // division and modulus ignoring signs
+        std::pair <integer, integer> dm(const integer & lhs) const;
+
+        friend class integer;
+
+    public:
+        // throws std::domain_error if the divisor is 0
+        reciprocal(const integer & divisor);
+
+        const integer & divisor() const;
+
+        // same results as integer::divmod(lhs, divisor())
+        std::pair <integer, integer> divmod(const integer & lhs) const;
+        integer div(const integer & lhs) const;
+        integer mod(const integer & lhs) const;
+};
+
+// Barrett reduction
+// as described in the Handbook of Applied Cryptography, Algorithm 14.42
+// mu = floor(B^(2n) / m) is found once, where m has n digits. After that,
+// any value of up to 2n digits, which includes every value below m^2, is
+// reduced with two multiplications, a subtraction, and at most two
+// corrections. Larger values fall back to operator%.
+class barrett_reducer{
+    private:
+        integer _modulus;                       // modulus as given
+        integer _m;                             // absolute value of the modulus
+        integer _mu;                            // floor(B^(2n) / _m)
+        integer::REP_SIZE_T _n;                 // number of digits in _m
+
+    public:
+        // throws std::domain_error if the modulus is 0
+        barrett_reducer(const integer & modulus);
+
+        const integer & modulus() const;
+
+        // same result as value % modulus()
+        integer reduce(const integer & value) const;
+};
+
+// Montgomery multiplication
+// as described in "Modular Multiplication Without Trial Division" by Peter L. Montgomery
+// Values are kept in Montgomery form x * R mod m, where R = B^n for an odd n digit
+// modulus m. Products are reduced with REDC, which divides by R instead of m, so
+// modular exponentiation runs without any divisions after the setup.
+class montgomery_context{
+    private:
+        integer _modulus;                       // modulus as given
+        integer _m;                             // absolute value of the modulus
+        integer _r2;                            // R^2 mod m
+        integer _inverse;                       // -m^-1 mod R
+        INTEGER_DIGIT_T _digit;                 // -m^-1 mod B
+        integer::REP_SIZE_T _n;                 // number of digits in _m
+
+        // value * R^-1 mod m, where 0 <= value < m * R
+        // Small moduli are reduced one digit at a time, and large
+        // moduli are reduced with two multiplications.
+        integer redc(const integer & value) const;
+
+    public:
+        // throws std::domain_error if the modulus is even or 0
+        montgomery_context(const integer & modulus);
+
+        const integer & modulus() const;
+
+        // value * R mod m, for any value
+        integer to(const integer & value) const;
+
+        // value * R^-1 mod m, for values in Montgomery form
+        integer from(const integer & value) const;
+
+        // products of values in Montgomery form
+        integer mult(const integer & lhs, const integer & rhs) const;
+        integer sqr(const integer & value) const;
+
+        // same result as pow(base, exponent, modulus())
+        integer pow(const integer & base, const integer & exponent) const;
 };
 
+// Fixed base modular exponentiation
+// as described in the Handbook of Applied Cryptography, Algorithm 14.109 (Yao's method)
+// The powers base^(2^(k * i)) mod m are found once for exponents of up to a given
+// number of bits. Each exponent is then cut into k bit digits, and the powers are
+// multiplied together grouped by digit, which takes about bits / k + 2^k
+// multiplications and no squarings. Odd moduli use Montgomery multiplication.
+class fixed_base_pow{
+    private:
+        integer _base;                          // base as given
+        integer _modulus;                       // modulus as given
+        integer _m;                             // absolute value of the modulus
+        std::shared_ptr <const montgomery_context> _context;    // only set for odd moduli
+        unsigned int _window;                   // k
+        std::vector <integer> _powers;          // |base|^(2^(k * i)), in Montgomery form for odd moduli
+
+        integer mult(const integer & lhs, const integer & rhs) const;
+
+    public:
+        // exponents of up to bits bits use the table (the size of the modulus if 0)
+        // throws std::domain_error if the modulus is 0
+        fixed_base_pow(const integer & base, const integer & modulus, const integer::REP_SIZE_T & bits = 0);
+
+        // same result as pow(base, exponent, modulus)
+        // larger exponents fall back to pow
+        integer pow(const integer & exponent) const;
+};
+
+// Read only view of a value whose digits are stored somewhere else, such
+// as a memory mapped file of little-endian digits, without copying them.
+// The digits have to be INTEGER_DIGIT_T in the byte order of the machine,
+// and have to stay alive and unchanged while the view is in use. Top zero
+// digits are skipped. Integers convert to views implicitly.
+//
+// Views can be compared, tested bit by bit, and used as operands of
+// multiplication and division. Products and quotients are returned as
+// ordinary integers, and only the result is allocated. Divisors large
+// enough for Newton division are copied once, since it works on
+// normalized copies of the operands anyway.
+//
+//     const INTEGER_DIGIT_T * digits = static_cast <const INTEGER_DIGIT_T *> (mmap(...));
+//     integer_view x(digits, length / sizeof(INTEGER_DIGIT_T));
+//     integer q = x / m;
+class integer_view{
+    private:
+        const INTEGER_DIGIT_T * _digits;
+        integer::REP_SIZE_T     _size;
+        integer::Sign           _sign;
+
+    public:
+        integer_view();
+        integer_view(const integer & value);
+        integer_view(const INTEGER_DIGIT_T * digits, const integer::REP_SIZE_T & size, const integer::Sign & sign = integer::POSITIVE);
+        integer_view(const integer_span & span);
+
+        // compare values with signs
+        // returns a negative value, 0, or a positive value if lhs is less than, equal to, or greater than rhs
+        static int compare(const integer_view & lhs, const integer_view & rhs);
+
+        // same value with the other sign
+        integer_view operator-() const;
+
+        // get private values
+        const INTEGER_DIGIT_T * data()   const;
+        integer::REP_SIZE_T     digits() const;
+        integer::Sign           sign()   const;
+
+        // get minimum number of bits needed to hold this value
+        integer bits() const;
+
+        // get bit, where 0 is the lsb and bits() - 1 is the msb
+        bool operator[](const integer::REP_SIZE_T & b) const;
+
+        explicit operator bool() const;
+};
+
+// Comparison Operators
+// (integers on either side are taken as views without copying)
+bool operator==(const integer_view & lhs, const integer_view & rhs);
+bool operator==(const integer_view & lhs, const integer      & rhs);
+bool operator==(const integer      & lhs, const integer_view & rhs);
+bool operator!=(const integer_view & lhs, const integer_view & rhs);
+bool operator!=(const integer_view & lhs, const integer      & rhs);
+bool operator!=(const integer      & lhs, const integer_view & rhs);
+bool operator> (const integer_view & lhs, const integer_view & rhs);
+bool operator> (const integer_view & lhs, const integer      & rhs);
+bool operator> (const integer      & lhs, const integer_view & rhs);
+bool operator>=(const integer_view & lhs, const integer_view & rhs);
+bool operator>=(const integer_view & lhs, const integer      & rhs);
+bool operator>=(const integer      & lhs, const integer_view & rhs);
+bool operator< (const integer_view & lhs, const integer_view & rhs);
+bool operator< (const integer_view & lhs, const integer      & rhs);
+bool operator< (const integer      & lhs, const integer_view & rhs);
+bool operator<=(const integer_view & lhs, const integer_view & rhs);
+bool operator<=(const integer_view & lhs, const integer      & rhs);
+bool operator<=(const integer      & lhs, const integer_view & rhs);
+
+// Arithmetic Operators
+integer operator*(const integer_view & lhs, const integer_view & rhs);
+integer operator*(const integer_view & lhs, const integer      & rhs);
+integer operator*(const integer      & lhs, const integer_view & rhs);
+
+// division and modulus with signs, the same as integer::divmod
+// throws std::domain_error if rhs is 0
+std::pair <integer, integer> divmod(const integer_view & lhs, const integer_view & rhs);
+integer operator/(const integer_view & lhs, const integer_view & rhs);
+integer operator/(const integer_view & lhs, const integer      & rhs);
+integer operator/(const integer      & lhs, const integer_view & rhs);
+integer operator%(const integer_view & lhs, const integer_view & rhs);
+integer operator%(const integer_view & lhs, const integer      & rhs);
+integer operator%(const integer      & lhs, const integer_view & rhs);
+
+// writes a copy of the value with operator<<(std::ostream &, const integer &)
+std::ostream & operator<<(std::ostream & stream, const integer_view & rhs);
+
+// Caller owned buffer of digits that results are written into, such as a
+// field of a record kept in an arena. Like integer_view, it does not own
+// or allocate its digits. digits() is the size of the buffer, and the
+// functions that write into a span return a span over just the digits of
+// the result, with its sign. Spans convert to views implicitly.
+class integer_span{
+    private:
+        INTEGER_DIGIT_T *   _digits;
+        integer::REP_SIZE_T _size;
+        integer::Sign       _sign;
+
+    public:
+        integer_span();
+        integer_span(INTEGER_DIGIT_T * digits, const integer::REP_SIZE_T & size, const integer::Sign & sign = integer::POSITIVE);
+
+        // get private values
+        INTEGER_DIGIT_T *   data()   const;
+        integer::REP_SIZE_T digits() const;
+        integer::Sign       sign()   const;
+};
+
+// Arithmetic with views as operands, so that values kept outside of
+// integers are never copied on the way in. Results are written either
+// into a span or into an integer, which reuses its storage.
+//
+// Spans have to have room for:
+//     add, sub - max(lhs.digits(), rhs.digits()) + 1 digits
+//     mult     - lhs.digits() + rhs.digits() digits
+//     divmod   - lhs.digits() - rhs.digits() + 1 digits (at least 1) for the
+//                quotient and rhs.digits() digits for the remainder
+// or std::runtime_error is thrown. The output of add and sub may be the same
+// digits as lhs or rhs, so that values can be updated in place, but the
+// outputs of mult and divmod may not overlap the operands. Integer outputs
+// may be the same objects as the operands. divmod rounds toward 0, the same
+// as integer::divmod, and throws std::domain_error if rhs is 0.
+integer_span add (const integer_span & out, const integer_view & lhs, const integer_view & rhs);
+integer_span sub (const integer_span & out, const integer_view & lhs, const integer_view & rhs);
+integer_span mult(const integer_span & out, const integer_view & lhs, const integer_view & rhs);
+std::pair <integer_span, integer_span> divmod(const integer_span & quotient, const integer_span & remainder, const integer_view & lhs, const integer_view & rhs);
+
+integer & add (integer & out, const integer_view & lhs, const integer_view & rhs);
+integer & sub (integer & out, const integer_view & lhs, const integer_view & rhs);
+integer & mult(integer & out, const integer_view & lhs, const integer_view & rhs);
+void divmod(integer & quotient, integer & remainder, const integer_view & lhs, const integer_view & rhs);
+
 // Give integer type traits
 namespace std {  // This is probably not a good idea
     template <> struct is_arithmetic <integer> : std::true_type {};
@@ -613,14 +1679,14 @@ template <typename Z>
 bool operator==(const Z & lhs, const integer & rhs){
     static_assert(std::is_integral <Z>::value
                   , "Input type must be integral");
-    return (integer(lhs) == rhs);
+    return (rhs == lhs);
 }
 
 template <typename Z>
 bool operator!=(const Z & lhs, const integer & rhs){
     static_assert(std::is_integral <Z>::value
                   , "Input type must be integral");
-    return (integer(lhs) != rhs);
+    return (rhs != lhs);
 }
 
 template <typename Z>
@@ -656,7 +1722,7 @@ template <typename Z>
 integer operator+(const Z & lhs, const integer & rhs){
     static_assert(std::is_integral <Z>::value
                   , "Input type must be integral");
-    return integer(lhs) + rhs;
+    return rhs + lhs;
 }
 
 template <typename Z>
@@ -664,14 +1730,17 @@ Z & operator+=(Z & lhs, const integer & rhs){
     static_assert(std::is_integral <Z>::value &&
                  !std::is_const <Z>::value
                   , "Input type must be integral");
-    return lhs = static_cast <Z> (integer(lhs) + rhs);
+    return lhs = static_cast <Z> (rhs + lhs);
 }
 
 template <typename Z>
 integer operator-(const Z & lhs, const integer & rhs){
     static_assert(std::is_integral <Z>::value
                   , "Input type must be integral");
-    return integer(lhs) - rhs;
+    integer out(rhs);
+    out -= lhs;
+    out.negate();
+    return out;
 }
 
 template <typename Z>
@@ -679,14 +1748,14 @@ Z & operator-=(Z & lhs, const integer & rhs){
     static_assert(std::is_integral <Z>::value &&
                  !std::is_const <Z>::value
                   , "Input type must be integral");
-    return lhs = static_cast <Z> (integer(lhs) - rhs);
+    return lhs = static_cast <Z> (lhs - rhs);
 }
 
 template <typename Z>
 integer operator*(const Z & lhs, const integer & rhs){
     static_assert(std::is_integral <Z>::value
                   , "Input type must be integral");
-    return integer(lhs) * rhs;
+    return rhs * lhs;
 }
 
 template <typename Z>
@@ -694,7 +1763,7 @@ Z & operator*=(Z & lhs, const integer & rhs){
     static_assert(std::is_integral <Z>::value &&
                  !std::is_const <Z>::value
                   , "Input type must be integral");
-    return lhs = static_cast <Z> (integer(lhs) * rhs);
+    return lhs = static_cast <Z> (rhs * lhs);
 }
 
 template <typename Z>
@@ -728,6 +1797,13 @@ Z & operator%=(Z & lhs, const integer & rhs){
 }
 
 // IO Operators
+// Digits are written to and read from the stream buffer in pieces, without
+// building a string of the whole value. std::oct and std::hex select the
+// base, and output follows std::showbase, std::showpos, std::uppercase,
+// width, fill, and std::left/std::right/std::internal. Input skips leading
+// whitespace, reads an optional '-' and, in hexadecimal, an optional "0x",
+// and throws std::runtime_error if the token has characters that are not
+// digits.
 std::ostream & operator<<(std::ostream & stream, const integer & rhs);
 std::istream & operator>>(std::istream & stream, integer & rhs);
 
@@ -736,6 +1812,156 @@ std::string makebin  (const integer & value, const unsigned int & size = 1);
 std::string makehex  (const integer & value, const unsigned int & size = 1);
 std::string makeascii(const integer & value, const unsigned int & size = 1);
 
+// Conversions to and from caller provided buffers in bases 2 to 16 and 256
+// Like std::to_chars and std::from_chars, errors are reported in the result
+// instead of being thrown:
+//     std::errc::invalid_argument - the base is not supported, or there are no digits
+//     std::errc::value_too_large  - the buffer is too small (ptr is last, and
+//                                   the contents of the buffer are unspecified)
+//
+// to_chars never allocates. Bases other than 2, 4, 8, 16, and 256 are divided
+// one digit sized chunk at a time, so they take quadratic time, and values of
+// more than a few digits are held at the end of the buffer while being divided.
+//
+// from_chars reads an optional '-' followed by as many digits as it can (no
+// sign in base 256). Bases other than 2, 4, 8, 16, and 256 are also read one
+// digit sized chunk at a time, in quadratic time, below
+// integer::from_chars_threshold bits. Larger inputs are combined in halves like
+// the string constructor does, which allocates. Otherwise, it only allocates when value does not
+// already have room for the result. value is left unchanged on errors.
+
+// number of characters that to_chars needs, or 0 if the base is not
+// supported. Bases that are not powers of 2 estimate the length from the top
+// bits without allocating. The estimate is exact except for values too close
+// to a power of the base to tell which side of it they are on, which are
+// given room for one more character than they might use.
+std::size_t to_chars_length(const integer & value, const int & base = 10);
+integer::to_chars_result to_chars(char * first, char * last, const integer & value, const int & base = 10);
+integer::from_chars_result from_chars(const char * first, const char * last, integer & value, const int & base = 10);
+
+// Copy the absolute value to and from arrays of count words of size bytes
+// each, like mpz_import and mpz_export. The bytes are copied into place
+// without any arithmetic, and with a single memcpy when the layout matches
+// the digits in memory.
+//     endian:  1 - most significant byte of each word first
+//             -1 - least significant byte of each word first
+//              0 - the byte order of the machine
+//     order:   1 - most significant word first
+//             -1 - least significant word first
+// The defaults read and write big endian byte strings. import_bytes makes
+// value positive. export_bytes writes export_bytes_length(value, size) words,
+// padding the most significant word with zeros, and returns that count
+// (0 for zero). A word size of 0 throws std::runtime_error.
+void import_bytes(integer & value, const void * data, const std::size_t & count, const std::size_t & size = 1, const int & endian = 1, const int & order = 1);
+std::size_t export_bytes_length(const integer & value, const std::size_t & size = 1);
+std::size_t export_bytes(void * data, const integer & value, const std::size_t & size = 1, const int & endian = 1, const int & order = 1);
+
+// Binary serialization
+// Version 1 of the format is a header followed by the magnitude, and does not
+// depend on the digit type:
+//     header: an unsigned LEB128 varint h (7 bits per byte, least significant
+//             first, with the high bit set on every byte but the last)
+//         h & 1 - 1 if the value is negative
+//         h & 2 - 1 if the magnitude is h >> 2, with nothing following it
+//                 0 if h >> 2 bytes of the magnitude follow, least significant first
+// Whichever form is shorter is written, so values with magnitudes below 32
+// take one byte and below 4096 take two. The header 1 (a negative value with
+// no bytes) is never written, and is reserved for marking later versions.
+//
+// serialize writes bytes to out and returns the end of them. deserialize reads
+// one value from [first, last) into value and returns the iterator after it,
+// so values can be read back to back. It throws std::runtime_error if the
+// input ends early, the header is malformed, or the version is not supported.
+
+// number of bytes serialize writes
+std::size_t serialized_size(const integer & value);
+
+template <typename OutputIt>
+OutputIt serialize(const integer & value, OutputIt out){
+    uint64_t header = 0;
+    const std::size_t count = value.serial_header(header);
+
+    while (header > 0x7f){
+        *out = static_cast <unsigned char> ((header & 0x7f) | 0x80);
+        ++out;
+        header >>= 7;
+    }
+    *out = static_cast <unsigned char> (header);
+    ++out;
+
+    // copy the digits out a byte at a time
+    for(std::size_t i = 0; i < count; i++){
+        *out = static_cast <unsigned char> (value._value[i / integer::OCTETS] >> ((i % integer::OCTETS) << 3));
+        ++out;
+    }
+
+    return out;
+}
+
+template <typename InputIt>
+InputIt deserialize(InputIt first, InputIt last, integer & value){
+    uint64_t header = 0;
+    for(unsigned int shift = 0;; shift += 7){
+        if (first == last){
+            throw std::runtime_error("Error: Serialized value is too short");
+        }
+
+        const uint64_t byte = static_cast <unsigned char> (*first);
+        ++first;
+
+        if ((shift > 63) || ((shift == 63) && (byte > 1))){
+            throw std::runtime_error("Error: Serialized header is too long");
+        }
+
+        header |= (byte & 0x7f) << shift;
+        if (!(byte & 0x80)){
+            break;
+        }
+    }
+
+    if (header == 1){
+        throw std::runtime_error("Error: Unsupported serialization version");
+    }
+
+    // decoded on the side, so that errors leave value alone
+    integer out;
+    if (header & 2){
+        out = integer(header >> 2);
+    }
+    else{
+        // the count has not been checked against the input yet,
+        // so only reserve a bounded amount of memory up front
+        const uint64_t count = header >> 2;
+        out._value.clear();
+        out._value.reserve(static_cast <integer::REP_SIZE_T> (std::min <uint64_t> (count, 1 << 16) / integer::OCTETS + 1));
+
+        INTEGER_DIGIT_T digit = 0;
+        for(uint64_t i = 0; i < count; i++){
+            if (first == last){
+                throw std::runtime_error("Error: Serialized value is too short");
+            }
+
+            digit |= static_cast <INTEGER_DIGIT_T> (static_cast <INTEGER_DIGIT_T> (static_cast <unsigned char> (*first)) << ((i % integer::OCTETS) << 3));
+            ++first;
+
+            if ((i % integer::OCTETS) == (integer::OCTETS - 1)){
+                out._value.push_back(digit);
+                digit = 0;
+            }
+        }
+
+        if (count % integer::OCTETS){
+            out._value.push_back(digit);
+        }
+    }
+
+    out._sign = (header & 1)?integer::NEGATIVE:integer::POSITIVE;
+    out.trim();
+    value = std::move(out);
+
+    return first;
+}
+
 integer abs(const integer & value);
 
 // floor(log_b(x))
@@ -756,6 +1982,70 @@ integer log(integer value, Z base){
     return count;
 }
 
+// number of bits in each window of sliding window exponentiation
+// for an exponent with the given number of bits
+unsigned int pow_window(const integer::REP_SIZE_T & bits);
+
+// Sliding window exponentiation
+// as described in the Handbook of Applied Cryptography, Algorithm 14.85
+// The exponent is read from the top in windows of up to k bits that start and
+// end with a set bit, so only the odd powers base^1, base^3, ..., base^(2^k - 1)
+// are needed, and each window costs one multiplication on top of the squarings.
+// The exponent must be positive. mult and sqr multiply and square values.
+template <typename Mult, typename Sqr>
+integer window_pow(const integer & base, const integer & exponent, Mult mult, Sqr sqr){
+    const integer::REP_SIZE_T bits = static_cast <integer::REP_SIZE_T> (exponent.bits());
+    const unsigned int k = pow_window(bits);
+
+    // odd powers of the base
+    std::vector <integer> odd(1, base);
+    if (k > 1){
+        const integer square = sqr(base);
+        for(std::size_t i = 1; i < (static_cast <std::size_t> (1) << (k - 1)); i++){
+            odd.push_back(mult(odd.back(), square));
+        }
+    }
+
+    // the top bit is set, so the first window
+    // sets the result instead of multiplying it
+    integer result;
+    bool started = false;
+    integer::REP_SIZE_T i = bits;
+    while (i){
+        if (!exponent[i - 1]){
+            result = sqr(result);
+            i--;
+            continue;
+        }
+
+        // the longest window of up to k bits that ends with a set bit
+        integer::REP_SIZE_T low = (i > k)?(i - k):0;
+        while (!exponent[low]){
+            low++;
+        }
+
+        std::size_t window = 0;
+        for(integer::REP_SIZE_T j = i; j > low; j--){
+            window = (window << 1) | exponent[j - 1];
+        }
+
+        if (started){
+            for(integer::REP_SIZE_T j = low; j < i; j++){
+                result = sqr(result);
+            }
+            result = mult(result, odd[window >> 1]);
+        }
+        else{
+            result = odd[window >> 1];
+            started = true;
+        }
+
+        i = low;
+    }
+
+    return result;
+}
+
 template <typename Z>
 integer pow(integer value, Z exp){
     static_assert(std::is_integral <Z>::value
@@ -765,17 +2055,13 @@ integer pow(integer value, Z exp){
         return 0;
     }
 
-    Z one = 1;
-    integer result = 1;
-    while (exp){
-        if (exp & one){
-            result *= value;
-        }
-        exp >>= one;
-        value *= value;
+    if (!exp){
+        return 1;
     }
 
-    return result;
+    return window_pow(value, exp,
+                      [](const integer & lhs, const integer & rhs){ return lhs * rhs; },
+                      [](const integer & value){ return value.sqr(); });
 }
 
 template <typename Z_e, typename Z_m>
@@ -792,20 +2078,49 @@ integer pow(integer base, Z_e exponent, const Z_m modulus){
         return 0;
     }
 
-    const Z_e one = 1;
-    integer exp = exponent;
+    const integer exp = exponent;
     const integer mod = modulus;
 
-    integer result = one;
-    while (exp){
-        if (exp & one){
-            result = (result * base) % mod;
-        }
-        exp >>= one;
-        base = (base * base) % mod;
+    // odd moduli do not need any divisions
+    if (mod[0]){
+        return montgomery_context(mod).pow(base, exp);
     }
 
-    return result;
+    if (!exp){
+        return 1;
+    }
+
+    return window_pow(base % mod, exp,
+                      [&mod](const integer & lhs, const integer & rhs){ return (lhs * rhs) % mod; },
+                      [&mod](const integer & value){ return value.sqr() % mod; });
+}
+
+// modular exponentiation that reuses the precomputed
+// values of a Barrett reducer instead of dividing
+template <typename Z_e>
+integer pow(integer base, Z_e exponent, const barrett_reducer & reducer){
+    static_assert(std::is_integral <Z_e>::value
+                  , "Exponent type should be integral");
+
+    if (exponent < 0){
+        return 0;
+    }
+
+    if (!exponent){
+        return 1;
+    }
+
+    return window_pow(reducer.reduce(base), exponent,
+                      [&reducer](const integer & lhs, const integer & rhs){ return reducer.reduce(lhs * rhs); },
+                      [&reducer](const integer & value){ return reducer.reduce(value.sqr()); });
+}
+
+// modular exponentiation with Montgomery multiplication
+template <typename Z_e>
+integer pow(integer base, Z_e exponent, const montgomery_context & context){
+    static_assert(std::is_integral <Z_e>::value
+                  , "Exponent type should be integral");
+    return context.pow(base, exponent);
 }
 
 #endif // INTEGER_H
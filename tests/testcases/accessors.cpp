@@ -46,25 +46,26 @@ TEST(Accessor, data){
     integer::REP data;
 
     // this should be a macro
+    // digits are stored least significant first
     if (std::is_same <INTEGER_DIGIT_T, uint8_t>::value){
-        data = {(INTEGER_DIGIT_T) 0xfe,
-                (INTEGER_DIGIT_T) 0xdc,
-                (INTEGER_DIGIT_T) 0xba,
-                (INTEGER_DIGIT_T) 0x98,
-                (INTEGER_DIGIT_T) 0x76,
-                (INTEGER_DIGIT_T) 0x54,
+        data = {(INTEGER_DIGIT_T) 0x10,
                 (INTEGER_DIGIT_T) 0x32,
-                (INTEGER_DIGIT_T) 0x10};
+                (INTEGER_DIGIT_T) 0x54,
+                (INTEGER_DIGIT_T) 0x76,
+                (INTEGER_DIGIT_T) 0x98,
+                (INTEGER_DIGIT_T) 0xba,
+                (INTEGER_DIGIT_T) 0xdc,
+                (INTEGER_DIGIT_T) 0xfe};
     }
     else if (std::is_same <INTEGER_DIGIT_T, uint16_t>::value){
-        data = {(INTEGER_DIGIT_T) 0xfedc,
-                (INTEGER_DIGIT_T) 0xba98,
+        data = {(INTEGER_DIGIT_T) 0x3210,
                 (INTEGER_DIGIT_T) 0x7654,
-                (INTEGER_DIGIT_T) 0x3210};
+                (INTEGER_DIGIT_T) 0xba98,
+                (INTEGER_DIGIT_T) 0xfedc};
     }
     else if (std::is_same <INTEGER_DIGIT_T, uint32_t>::value){
-        data = {(INTEGER_DIGIT_T) 0xfedcba98,
-                (INTEGER_DIGIT_T) 0x76543210};
+        data = {(INTEGER_DIGIT_T) 0x76543210,
+                (INTEGER_DIGIT_T) 0xfedcba98};
     }
     else if (std::is_same <INTEGER_DIGIT_T, uint64_t>::value){
         data = {(INTEGER_DIGIT_T) 0xfedcba9876543210};
@@ -0,0 +1,325 @@
+#include <cstdlib>
+#include <new>
+
+#include <gtest/gtest.h>
+
+#include "integer.h"
+
+// count every heap allocation made by the test program
+static std::size_t allocations = 0;
+
+void * operator new(std::size_t size){
+    allocations++;
+    if (void * ptr = std::malloc(size?size:1)){
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+// the replacement operator new uses malloc, so free is correct here
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 11)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void * ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 11)
+#pragma GCC diagnostic pop
+#endif
+
+TEST(Allocation, small){
+    const integer a((uint64_t) 0xfedcba9876543210ULL);
+    const integer b(-12345);
+    const integer c = (a << 60) + 1;                    // 124 bits
+
+    const std::size_t before = allocations;
+
+    integer value = a;
+    value = c;
+    value = integer(b);
+    value = a + b;
+    value = a - b;
+    value = c * 15;
+    value = a * b;
+    value = c / b;
+    value = c % 12345;
+    value = c >> 7;
+    value = a << 64;
+    value = a & b;
+    value = a | c;
+    value = -c;
+    value = (a > b) && (c != a) && (a <= c);
+    for(int i = 0; i < 1000; i++){
+        value = a + i;
+    }
+
+    EXPECT_EQ(allocations, before);
+}
+
+TEST(Allocation, spill){
+    const integer a((uint64_t) 0xfedcba9876543210ULL);
+
+    const std::size_t before = allocations;
+    const integer big = a << INTEGER_INLINE_BITS;       // does not fit inside of the object
+    EXPECT_GT(allocations, before);
+
+    // values that shrink back down still work
+    EXPECT_EQ(big >> INTEGER_INLINE_BITS, a);
+    EXPECT_EQ((big * big) / big, big);
+}
+
+TEST(Allocation, compound){
+    const integer x = (integer(1) << 900) + 12345;
+    integer sum = integer(1) << 1000;
+
+    // make room for the largest intermediate value
+    sum *= 3;
+    sum >>= 2;
+
+    const std::size_t before = allocations;
+    for(int i = 0; i < 1000; i++){
+        sum += x;
+        sum -= 1;
+        sum <<= 3;
+        sum >>= 3;
+        sum ^= x;
+        sum |= 1;
+        sum &= sum;
+        sum *= 3;
+        sum >>= 2;
+    }
+    EXPECT_EQ(allocations, before);
+
+    integer expected = integer(1) << 1000;
+    expected *= 3;
+    expected >>= 2;
+    for(int i = 0; i < 1000; i++){
+        expected = ((((((expected + x) - 1) ^ x) | 1) * 3) >> 2);
+    }
+    EXPECT_EQ(sum, expected);
+}
+
+TEST(Allocation, builtin){
+    integer value = (integer(1) << 1000) - 1;
+    const integer start = value;
+
+    // make room for the largest intermediate value
+    value *= 1000;
+    value = start;
+
+    bool same = true;
+    const std::size_t before = allocations;
+    for(int i = 1; i < 256; i++){     // fits in a single digit of any width
+        value += i;
+        value -= i;
+        value *= i;
+        value /= i;
+        value -= -i;
+        value += -i;
+        same = same && (value % i == start % i) && (value > i) && (value != -i) && !(value == i);
+    }
+    value <<= 5;
+    value >>= 5;
+    EXPECT_EQ(allocations, before);
+
+    EXPECT_TRUE(same);
+
+    EXPECT_EQ(value, start);
+    EXPECT_EQ(value * 7, value * integer(7));
+    EXPECT_EQ(-value / 7, -value / integer(7));
+    EXPECT_EQ(-value % 7, -value % integer(7));
+    EXPECT_THROW(value / 0, std::domain_error);
+    EXPECT_THROW(value % 0, std::domain_error);
+}
+
+TEST(Allocation, chars){
+    const integer value = -pow(integer(7), integer(3000));     // about 8400 bits
+    char buffer[10000];
+
+    const integer negated = -value;
+
+    // make room for the result
+    integer parsed = value * value;
+
+    bool same = true;
+    const std::size_t before = allocations;
+    for(int base : {2, 7, 10, 16, 256}){
+        const integer::to_chars_result written = to_chars(buffer, buffer + sizeof(buffer), value, base);
+        const integer::from_chars_result read = from_chars(buffer + (base == 256), written.ptr, parsed, base);
+        same = same && (written.ec == std::errc()) && (read.ec == std::errc()) && (read.ptr == written.ptr);
+        same = same && (parsed == ((base == 256)?negated:value));
+    }
+    EXPECT_EQ(allocations, before);
+
+    EXPECT_TRUE(same);
+}
+
+// passes allocations on to operator new and counts them
+class counting_resource : public integer_memory_resource{
+    public:
+        std::size_t allocated = 0;
+        std::size_t deallocated = 0;
+
+        void * allocate(const std::size_t & bytes){
+            allocated++;
+            return ::operator new(bytes);
+        }
+
+        void deallocate(void * ptr, const std::size_t &){
+            deallocated++;
+            ::operator delete(ptr);
+        }
+};
+
+TEST(Allocation, resource){
+    const integer a = pow(integer(3), integer(500));
+    counting_resource counter;
+
+    EXPECT_EQ(integer_memory_resource::current(), nullptr);
+    {
+        integer_memory_scope scope(&counter);
+        EXPECT_EQ(integer_memory_resource::current(), &counter);
+
+        const integer b = a * a + 1;
+        EXPECT_EQ(b % a, 1);
+        EXPECT_GT(counter.allocated, 0);
+
+        // small values stay inside of the object
+        const std::size_t before = counter.allocated;
+        integer small = 12345;
+        small *= 7;
+        EXPECT_EQ(counter.allocated, before);
+    }
+    EXPECT_EQ(integer_memory_resource::current(), nullptr);
+    EXPECT_EQ(counter.deallocated, counter.allocated);
+
+    // values made inside of a scope are freed by the resource they came from
+    std::size_t before = 0;
+    {
+        integer kept;
+        {
+            integer_memory_scope scope(&counter);
+            kept = a << 1000;
+        }
+        before = counter.deallocated;
+        EXPECT_EQ(kept >> 1000, a);
+    }
+    EXPECT_EQ(counter.deallocated, before + 1);
+}
+
+TEST(Allocation, monotonic){
+    const integer a = pow(integer(3), integer(600));        // about 950 bits
+    const integer b = pow(integer(7), integer(300)) + 1;    // about 840 bits
+    const integer expected = ((a * b + a) / b) % (b - 5);
+
+    char buffer[1 << 14];
+    integer_monotonic_resource arena(buffer, sizeof(buffer));
+
+    const std::size_t before = allocations;
+    for(int i = 0; i < 10; i++){
+        {
+            integer_memory_scope scope(&arena);
+            const integer value = ((a * b + a) / b) % (b - 5);
+            EXPECT_EQ(value, expected);
+        }
+        arena.release();
+    }
+    EXPECT_EQ(allocations, before);
+
+    // more than the buffer holds
+    {
+        integer_memory_scope scope(&arena);
+        const integer large = pow(a, integer(40));
+        EXPECT_EQ(large % a, 0);
+    }
+    EXPECT_GT(allocations, before);
+    arena.release();
+}
+
+TEST(Allocation, scratch){
+    const integer a = pow(integer(3), integer(3000)) + 7;      // about 4750 bits
+    const integer b = pow(integer(7), integer(1000)) - 1;      // about 2800 bits
+    const integer c = pow(integer(5), integer(300));           // about 700 bits
+
+    // the number theoretic transform is also used at a size that would use Karatsuba
+    const integer::REP_SIZE_T toom3 = integer::toom3_threshold;
+    const integer::REP_SIZE_T toom4 = integer::toom4_threshold;
+    const integer::REP_SIZE_T ntt   = integer::ntt_threshold;
+
+    integer karatsuba, pieces, transform, quotient, remainder;
+    std::size_t before = 0;
+
+    // the first pass grows the scratch memory and the outputs
+    for(int i = 0; i < 2; i++){
+        before = allocations;
+        mult(karatsuba, a, b);
+        mult(pieces, a, c);                         // pieces of a the size of c
+        integer::toom3_threshold = integer::toom4_threshold = integer::ntt_threshold = integer::karatsuba_threshold;
+        mult(transform, a, b);
+        integer::toom3_threshold = toom3;
+        integer::toom4_threshold = toom4;
+        integer::ntt_threshold   = ntt;
+        divmod(quotient, remainder, a, b);          // Knuth division
+    }
+    EXPECT_EQ(allocations, before);
+
+    EXPECT_EQ(karatsuba, a * b);
+    EXPECT_EQ(pieces,    a * c);
+    EXPECT_EQ(transform, a * b);
+    EXPECT_EQ(quotient,  a / b);
+    EXPECT_EQ(remainder, a % b);
+
+    // bitwise operators on negative values only allocate their results
+    const integer na = -a, nb = -b;
+    integer value;
+    before = allocations;
+    for(int i = 0; i < 10; i++){
+        value = na & b;
+        value = a | nb;
+        value = na ^ nb;
+    }
+    EXPECT_EQ(allocations - before, 30);
+    EXPECT_EQ(value, (-a) ^ (-b));
+}
+
+TEST(Allocation, recursive){
+    const integer a = pow(integer(3), integer(95000)) + 7;     // about 150000 bits
+    const integer b = pow(integer(7), integer(53000)) - 1;     // about 149000 bits
+    const integer c = pow(integer(3), integer(13000)) + 1;     // about 20600 bits
+    const integer d = pow(integer(7), integer(7000)) - 3;      // about 19650 bits
+
+    counting_resource counter;
+    integer toom3, toom4, square, q1, r1, q2, r2;
+    std::size_t before = 0, resource = 0;
+    {
+        integer_memory_scope scope(&counter);
+
+        // the first pass grows the scratch memory and the outputs
+        for(int i = 0; i < 2; i++){
+            before = allocations;
+            resource = counter.allocated;
+            mult(toom3, c, d);                      // Toom-3
+            mult(toom4, a, b);                      // Toom-4
+            mult(square, a, a);
+            divmod(q1, r1, a, c);                   // Burnikel-Ziegler division
+            divmod(q2, r2, b, d);
+        }
+        EXPECT_EQ(counter.allocated, resource);
+    }
+    EXPECT_EQ(allocations, before);
+
+    EXPECT_EQ(toom3,  c * d);
+    EXPECT_EQ(toom4,  a * b);
+    EXPECT_EQ(square, a * a);
+    EXPECT_EQ(q1 * c + r1, a);
+    EXPECT_LT(r1, c);
+    EXPECT_EQ(q2 * d + r2, b);
+    EXPECT_LT(r2, d);
+}
@@ -190,6 +190,26 @@ TEST(Constructor, int64_t){
     EXPECT_EQ(integer((int64_t) 0xfedcba9876543210).str(16), "-123456789abcdf0");
 }
 
+// __int128 is only integral with the GNU extensions
+#if defined(__SIZEOF_INT128__) && !defined(__STRICT_ANSI__)
+TEST(Constructor, int128){
+    const unsigned __int128 pattern = ((unsigned __int128) 0xfedcba9876543210ULL << 64) | 0x0123456789abcdefULL;
+
+    EXPECT_EQ(integer((unsigned __int128) 1 << 100).str(16),  "10000000000000000000000000");
+    EXPECT_EQ(integer(~(unsigned __int128) 0).str(16),        "ffffffffffffffffffffffffffffffff");
+    EXPECT_EQ(integer(pattern).str(16),                       "fedcba98765432100123456789abcdef");
+
+    EXPECT_EQ(integer((__int128) 1 << 100).str(16),           "10000000000000000000000000");
+    EXPECT_EQ(integer(-((__int128) 1 << 100)).str(16),        "-10000000000000000000000000");
+    EXPECT_EQ(integer((__int128) pattern).str(16),            "-123456789abcdeffedcba9876543211");
+    EXPECT_EQ(integer((__int128) ((unsigned __int128) 1 << 127)).str(16), "-80000000000000000000000000000000");
+
+    // mixed operators fall back to the constructor
+    EXPECT_EQ(integer(1) + ((__int128) 1 << 100), (integer(1) << 100) + 1);
+    EXPECT_EQ(integer(1) << 100, (unsigned __int128) 1 << 100);
+}
+#endif
+
 TEST(Constructor, string){
     const std::map <uint32_t, std::string> tests = {
         std::make_pair(2,   "101010001101000011010010111001100100000011010010111001100100000011000010010000001110011011101000111001001101001011011100110011100101110"),
@@ -225,6 +245,25 @@ TEST(Constructor, string){
     EXPECT_THROW(integer("",                   33), std::runtime_error);
 }
 
+TEST(Constructor, string_large){
+    // long strings are read in chunks that are joined with powers of the base
+    EXPECT_EQ(integer(std::string(3000, '9'), 10), pow(integer(10), integer(3000)) - 1);
+    EXPECT_EQ(integer("-1" + std::string(2999, '0') + "1", 10), -(pow(integer(10), integer(3000)) + 1));
+    EXPECT_EQ(integer(std::string(2500, 'F'), 16), (integer(1) << 10000) - 1);
+    EXPECT_EQ(integer(std::string(100, '0') + "1" + std::string(9999, '0'), 2), integer(1) << 9999);
+
+    integer value = 1;
+    for(int i = 0; i < 300; i++){
+        value = value * 0x9e3779b97f4a7c15ULL + i;
+    }
+    for(uint32_t base = 2; base <= 16; base++){
+        EXPECT_EQ(integer(value.str(base), base), value);
+    }
+
+    // a bad character at the end is still found
+    EXPECT_THROW(integer(std::string(3000, '9') + "a", 10), std::runtime_error);
+}
+
 TEST(Constructor, iterator){
     const std::string            string("\x0f\x0e\x0d\x0c\x0b\x0a\x09\x08\x07\x06\x05\x04\x03\x02\x01\x00", 16);
     const std::array  <int, 16>  array {0xf, 0xe, 0xd, 0xc, 0xb, 0xa, 0x9, 0x8, 0x7, 0x6, 0x5, 0x4, 0x3, 0x2, 0x1, 0x0};
@@ -239,4 +278,27 @@ TEST(Constructor, iterator){
     EXPECT_EQ(val, integer( deque.begin(),  deque.end(), 16));
     EXPECT_EQ(val, integer(  list.begin(),   list.end(), 16));
     EXPECT_EQ(val, integer(vector.begin(), vector.end(), 16));
+
+    // bases that are not powers of 2
+    const std::vector <int> decimal {1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3};
+    EXPECT_EQ(integer(decimal.begin(), decimal.end(), 10), integer("12345678901234567890123", 10));
+
+    // strings with high bytes in base 256
+    const std::string bytes("\xff\x80\x00\x7f", 4);
+    EXPECT_EQ(integer(bytes.begin(), bytes.end(), 256), integer((uint32_t) 0xff80007fUL));
+
+    // bases larger than a digit
+    const integer big_base = integer(1) << 100;
+    const std::vector <integer> big {1, big_base - 1, 0, 5};
+    EXPECT_EQ(integer(big.begin(), big.end(), big_base), (integer(1) << 300) + ((big_base - 1) << 200) + 5);
+
+    // long inputs
+    const std::vector <uint8_t> nines(3000, 9);
+    EXPECT_EQ(integer(nines.begin(), nines.end(), 10), pow(integer(10), integer(3000)) - 1);
+
+    // values that are not digits in the base
+    const std::vector <int> bad {1, 2, 10};
+    EXPECT_THROW(integer(bad.begin(), bad.end(), 10), std::runtime_error);
+    const std::vector <int> negative {1, -2, 3};
+    EXPECT_THROW(integer(negative.begin(), negative.end(), 10), std::runtime_error);
 }
@@ -33,6 +33,109 @@ TEST(Arithmetic, divide){
     EXPECT_THROW(integer(1) / integer(0), std::domain_error);
 }
 
+TEST(Arithmetic, divide_algorithms){
+    // values with long runs of set and cleared bits push the
+    // quotient digit estimates to their limits
+    std::vector <integer> values;
+    for(unsigned int bits : {7, 8, 63, 64, 65, 127, 128, 200, 255, 256, 257, 1000}){
+        const integer one = integer(1) << bits;
+        values.push_back(one);
+        values.push_back(one - 1);
+        values.push_back(one + 1);
+        values.push_back(one - (integer(1) << (bits / 2)));
+        values.push_back((one - 1) / 3);
+        values.push_back(((one - 1) / 0xf) << 1);
+    }
+    values.push_back(integer("123456789abcdef0123456789abcdef0123456789abcdef", 16));
+    values.push_back(integer("800000000000000000000000000000007fffffffffffffff", 16));
+
+    const integer::REP_SIZE_T thresholds[3] = {integer::burnikel_ziegler_threshold, integer::newton_threshold, integer::karatsuba_threshold};
+
+    // {burnikel_ziegler_threshold, newton_threshold, karatsuba_threshold}
+    // very small thresholds send every division through the recursive algorithms
+    const integer::REP_SIZE_T tiers[][3] = {
+        {thresholds[0], thresholds[1], thresholds[2]},
+        {0,             thresholds[1], thresholds[2]},
+        {100,           thresholds[1], thresholds[2]},
+        {300,           thresholds[1], thresholds[2]},
+        {thresholds[0], 0,             thresholds[2]},
+        {thresholds[0], 0,             0},
+        {100,           300,           0},
+    };
+
+    for(integer::REP_SIZE_T const * tier : tiers){
+        integer::burnikel_ziegler_threshold = tier[0];
+        integer::newton_threshold           = tier[1];
+        integer::karatsuba_threshold        = tier[2];
+
+        for(integer const & n : values){
+            for(integer const & d : values){
+                const integer q = n / d;
+                const integer r = n % d;
+                EXPECT_EQ(q * d + r, n);
+                EXPECT_GE(r, 0);
+                EXPECT_LT(r, d);
+
+                // signs follow truncation
+                EXPECT_EQ(-n /  d, -q);
+                EXPECT_EQ( n / -d, -q);
+                EXPECT_EQ(-n %  d, -r);
+                EXPECT_EQ( n % -d,  r);
+            }
+        }
+    }
+
+    integer::burnikel_ziegler_threshold = thresholds[0];
+    integer::newton_threshold           = thresholds[1];
+    integer::karatsuba_threshold        = thresholds[2];
+}
+
+TEST(Arithmetic, reciprocal){
+    const integer::REP_SIZE_T threshold = integer::karatsuba_threshold;
+
+    const integer dividends[] = {
+        0,
+        1,
+        -1,
+        integer("fedbca9876543210", 16),
+        (integer(1) << 1000) - 1,
+        -((integer(1) << 2500) + 12345),
+        integer("123456789abcdef0123456789abcdef0123456789abcdef", 16) << 3000,
+    };
+
+    const integer divisors[] = {
+        1,
+        -7,
+        integer("ffff", 16),
+        integer("fedbca9876543210", 16),
+        -((integer(1) << 200) - 1),
+        integer(1) << 255,
+        (integer(1) << 700) + (integer(1) << 350) + 1,
+    };
+
+    // a small karatsuba threshold makes the reciprocals
+    // of small divisors use Newton iteration
+    for(integer::REP_SIZE_T kt : {threshold, (integer::REP_SIZE_T) 0}){
+        integer::karatsuba_threshold = kt;
+
+        for(integer const & d : divisors){
+            const integer::reciprocal r(d);
+            EXPECT_EQ(r.divisor(), d);
+            for(integer const & n : dividends){
+                const std::pair <integer, integer> qr = r.divmod(n);
+                EXPECT_EQ(qr.first,  n / d);
+                EXPECT_EQ(qr.second, n % d);
+                EXPECT_EQ(r.div(n), n / d);
+                EXPECT_EQ(r.mod(n), n % d);
+            }
+        }
+    }
+
+    integer::karatsuba_threshold = threshold;
+
+    EXPECT_THROW(integer::reciprocal(0), std::domain_error);
+}
+
 TEST(External, divide){
     bool     t   = true;
     bool     f   = false;
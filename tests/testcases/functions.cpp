@@ -1,3 +1,4 @@
+#include <iomanip>
 #include <map>
 #include <random>
 
@@ -94,6 +95,58 @@ TEST(Function, str){
     EXPECT_EQ(neg_zero.str(256, leading), std::string(leading, 0));
 }
 
+TEST(Function, str_large){
+    // large values are split at powers of the base, so check values with
+    // long runs of the same digit, zeros in the middle, and round trips
+    const integer nines = pow(integer(10), integer(3000)) - 1;
+    EXPECT_EQ(nines.str(10), std::string(3000, '9'));
+    EXPECT_EQ((nines + 1).str(10), "1" + std::string(3000, '0'));
+    EXPECT_EQ((-(nines + 2)).str(10, 3005), "-00001" + std::string(2999, '0') + "1");
+    EXPECT_EQ(((integer(1) << 10000) - 1).str(16), std::string(2500, 'f'));
+    EXPECT_EQ(((integer(1) << 10000) + 1).str(2), "1" + std::string(9999, '0') + "1");
+
+    integer value = 1;
+    for(int i = 0; i < 300; i++){
+        value = value * 0x9e3779b97f4a7c15ULL + i;
+    }
+    for(uint32_t base = 2; base <= 16; base++){
+        const std::string str = value.str(base);
+        EXPECT_NE(str[0], '0');
+        EXPECT_EQ(integer(str, base), value);
+        EXPECT_EQ((-value).str(base), "-" + str);
+    }
+}
+
+TEST(Function, str_pow2){
+    // bases 2, 4, 8, and 16 regroup the bits, and octal groups straddle digits
+    std::string octal;
+    integer value = 0;
+    for(int i = 0; i < 500; i++){
+        octal += "01234567"[(i * 5 + 3) % 8];
+        value = (value << 3) + ((i * 5 + 3) % 8);
+    }
+    octal.erase(0, octal.find_first_not_of('0'));
+
+    EXPECT_EQ(value.str(8), octal);
+    EXPECT_EQ(integer(octal, 8), value);
+    EXPECT_EQ((-value).str(8, 600), "-" + std::string(600 - octal.size(), '0') + octal);
+    EXPECT_EQ(integer("-" + octal, 8), -value);
+    EXPECT_EQ(((integer(1) << 200) - 1).str(8), "3" + std::string(66, '7'));
+
+    for(uint32_t base : {2, 4, 8, 16}){
+        const std::string str = value.str(base);
+        EXPECT_EQ(integer(str, base), value);
+        EXPECT_EQ(integer("000" + str, base), value);
+        EXPECT_EQ(integer(str, base).str(base), str);
+    }
+
+    const integer pattern("0123456789abcdef0123456789abcdef01", 16);
+    EXPECT_EQ(makehex(pattern), "123456789abcdef0123456789abcdef01");
+    EXPECT_EQ(makehex(pattern, 36), "000123456789abcdef0123456789abcdef01");
+    EXPECT_EQ(makebin(pattern).substr(0, 13), "1001000110100");
+    EXPECT_EQ(makebin(pattern).size(), 129);
+}
+
 TEST(External, ostream){
     const integer value("fedcba9876543210", 16);
 
@@ -158,6 +211,83 @@ TEST(External, istream){
     EXPECT_THROW(bad >> value, std::runtime_error);
 }
 
+TEST(External, ostream_format){
+    const integer value("fedcba9876543210", 16);
+
+    std::stringstream base; base << std::showbase << std::hex << value << ' ' << std::oct << value << ' ' << std::dec << value << ' ' << std::hex << integer();
+    EXPECT_EQ(base.str(), "0xfedcba9876543210 01773345651416625031020 18364758544493064720 0");
+
+    std::stringstream upper; upper << std::showbase << std::uppercase << std::hex << -value;
+    EXPECT_EQ(upper.str(), "-0XFEDCBA9876543210");
+
+    std::stringstream pos; pos << std::showpos << value << ' ' << integer();
+    EXPECT_EQ(pos.str(), "+18364758544493064720 +0");
+
+    // width only applies to the next value
+    std::stringstream right; right << std::setw(8) << integer(-42) << std::setw(8) << std::setfill('*') << integer(42) << integer(42);
+    EXPECT_EQ(right.str(), "     -42******4242");
+
+    std::stringstream left; left << std::left << std::setfill('.') << std::setw(6) << integer(-42) << '|';
+    EXPECT_EQ(left.str(), "-42...|");
+
+    std::stringstream internal; internal << std::internal << std::showbase << std::hex << std::setfill('0') << std::setw(10) << integer(-255);
+    EXPECT_EQ(internal.str(), "-0x00000ff");
+
+    std::stringstream narrow; narrow << std::setw(2) << value;
+    EXPECT_EQ(narrow.str(), "18364758544493064720");
+}
+
+TEST(External, stream_large){
+    const integer value = -(pow(integer(3), integer(20000)) + 12345);    // about 31700 bits
+
+    const std::map <int, std::ios_base::fmtflags> bases = {{8, std::ios_base::oct}, {10, std::ios_base::dec}, {16, std::ios_base::hex}};
+    for(auto base : bases){
+        std::stringstream stream;
+        stream.setf(base.second, std::ios_base::basefield);
+        stream << value << ' ' << -value;
+        EXPECT_EQ(stream.str(), value.str(base.first) + " " + (-value).str(base.first));
+
+        integer a, b;
+        stream >> a >> b;
+        EXPECT_EQ(a, value);
+        EXPECT_EQ(b, -value);
+        EXPECT_TRUE(stream.eof());
+    }
+
+    // right below and at a power of the base, where the length is only estimated
+    const integer nines = pow(integer(10), integer(700)) - 1;
+    std::stringstream edges;
+    edges << std::setfill('*') << std::setw(703) << -nines << '|' << std::left << std::setw(703) << (nines + 1) << '|' << std::internal << std::setw(703) << -nines;
+    EXPECT_EQ(edges.str(), "**-" + std::string(700, '9') + "|1" + std::string(700, '0') + "**|-**" + std::string(700, '9'));
+}
+
+TEST(External, istream_format){
+    integer a, b, c;
+
+    // hexadecimal input may have a prefix
+    std::stringstream hex("0xff -0X10 0");
+    hex >> std::hex >> a >> b >> c;
+    EXPECT_EQ(a, 255);
+    EXPECT_EQ(b, -16);
+    EXPECT_EQ(c, 0);
+
+    // reading stops at whitespace and at width
+    std::stringstream split("  123\t456789");
+    split >> a >> std::setw(3) >> b >> c;
+    EXPECT_EQ(a, 123);
+    EXPECT_EQ(b, 456);
+    EXPECT_EQ(c, 789);
+    EXPECT_TRUE(split.eof());
+
+    // nothing left to read
+    split >> a;
+    EXPECT_TRUE(split.fail());
+    EXPECT_EQ(a, 0);
+
+    std::stringstream sign("-");
+    EXPECT_THROW(sign >> a, std::runtime_error);
+}
+
 TEST(External, makebin){
     for(auto t : tests){
         EXPECT_EQ(makebin(integer(t.second, t.first)), tests.at(2));
@@ -198,6 +328,274 @@ TEST(External, makeascii){
     EXPECT_EQ(makeascii(neg_zero, 5), std::string(5, '\x00'));
 }
 
+TEST(External, to_chars){
+    char buffer[4096];
+
+    const integer original("This is a string.", 256);
+    for(auto t : tests){
+        const integer::to_chars_result pos = to_chars(buffer, buffer + sizeof(buffer), original, t.first);
+        EXPECT_EQ(pos.ec, std::errc());
+        EXPECT_EQ(std::string(buffer, pos.ptr), t.second);
+        EXPECT_EQ(to_chars_length(original, t.first), t.second.size());
+
+        const integer::to_chars_result neg = to_chars(buffer, buffer + sizeof(buffer), -original, t.first);
+        EXPECT_EQ(neg.ec, std::errc());
+        EXPECT_EQ(std::string(buffer, neg.ptr), "-" + t.second);
+        EXPECT_EQ(to_chars_length(-original, t.first), t.second.size() + 1);
+    }
+
+    // zero
+    integer::to_chars_result result = to_chars(buffer, buffer + 1, integer("-0", 10), 10);
+    EXPECT_EQ(result.ec, std::errc());
+    EXPECT_EQ(std::string(buffer, result.ptr), "0");
+
+    // large values need as much room as to_chars_length says, which can be
+    // one more than that around powers of the base
+    integer value = 1;
+    for(int i = 0; i < 40; i++){
+        value = value * 0x9e3779b97f4a7c15ULL + i;
+    }
+    for(const integer & v : {value, -value, pow(integer(10), integer(700)), pow(integer(10), integer(700)) - 1, pow(integer(7), integer(500)), -pow(integer(7), integer(500))}){
+        for(int base : {2, 3, 7, 8, 10, 15, 16, 256}){
+            const std::size_t length = v.str(base).size();
+            EXPECT_GE(to_chars_length(v, base), length);
+            EXPECT_LE(to_chars_length(v, base), length + 1);
+
+            result = to_chars(buffer, buffer + length, v, base);
+            EXPECT_EQ(result.ec, std::errc());
+            EXPECT_EQ(result.ptr, buffer + length);
+            EXPECT_EQ(std::string(buffer, result.ptr), v.str(base));
+
+            result = to_chars(buffer, buffer + length - 1, v, base);
+            EXPECT_EQ(result.ec, std::errc::value_too_large);
+            EXPECT_EQ(result.ptr, buffer + length - 1);
+        }
+    }
+
+    // unsupported bases
+    for(int base : {-1, 0, 1, 17, 255, 257}){
+        result = to_chars(buffer, buffer + sizeof(buffer), original, base);
+        EXPECT_EQ(result.ec, std::errc::invalid_argument);
+        EXPECT_EQ(result.ptr, buffer);
+        EXPECT_EQ(to_chars_length(original, base), 0);
+    }
+}
+
+TEST(External, from_chars){
+    const integer original("This is a string.", 256);
+    for(auto t : tests){
+        integer value;
+        const integer::from_chars_result result = from_chars(t.second.data(), t.second.data() + t.second.size(), value, t.first);
+        EXPECT_EQ(result.ec, std::errc());
+        EXPECT_EQ(result.ptr, t.second.data() + t.second.size());
+        EXPECT_EQ(value, original);
+    }
+
+    // reading stops at the first character that is not a digit
+    const std::string mixed = "-12345678901234567890123456789z9";
+    integer value;
+    integer::from_chars_result result = from_chars(mixed.data(), mixed.data() + mixed.size(), value, 10);
+    EXPECT_EQ(result.ec, std::errc());
+    EXPECT_EQ(result.ptr, mixed.data() + mixed.size() - 2);
+    EXPECT_EQ(value, integer("-12345678901234567890123456789", 10));
+
+    result = from_chars(mixed.data() + 1, mixed.data() + mixed.size(), value, 8);
+    EXPECT_EQ(result.ec, std::errc());
+    EXPECT_EQ(result.ptr, mixed.data() + 8);
+    EXPECT_EQ(value, 01234567);
+
+    result = from_chars(mixed.data(), mixed.data() + mixed.size(), value, 16);
+    EXPECT_EQ(result.ptr, mixed.data() + mixed.size() - 2);
+    EXPECT_EQ(value, integer("-12345678901234567890123456789", 16));
+
+    // errors leave the value alone
+    const integer before = value;
+    for(const std::string & bad : {std::string(""), std::string("-"), std::string("z"), std::string("+1"), std::string("-z")}){
+        result = from_chars(bad.data(), bad.data() + bad.size(), value, 10);
+        EXPECT_EQ(result.ec, std::errc::invalid_argument);
+        EXPECT_EQ(result.ptr, bad.data());
+        EXPECT_EQ(value, before);
+    }
+    result = from_chars(mixed.data(), mixed.data() + mixed.size(), value, 17);
+    EXPECT_EQ(result.ec, std::errc::invalid_argument);
+    EXPECT_EQ(value, before);
+
+    // round trips through large buffers
+    char buffer[4096];
+    integer large = 1;
+    for(int i = 0; i < 60; i++){
+        large = large * -0x9e3779b97f4a7c15LL + i;
+    }
+    large = -large;
+    for(int base : {2, 3, 8, 10, 13, 16, 256}){
+        const integer::to_chars_result written = to_chars(buffer, buffer + sizeof(buffer), large, base);
+        EXPECT_EQ(written.ec, std::errc());
+
+        // base 256 reads the '-' as a byte
+        const char * start = buffer + (base == 256);
+        result = from_chars(start, written.ptr, value, base);
+        EXPECT_EQ(result.ec, std::errc());
+        EXPECT_EQ(result.ptr, written.ptr);
+        EXPECT_EQ(value, (base == 256)?-large:large);
+    }
+
+    // inputs that are combined in halves
+    const integer::REP_SIZE_T threshold = integer::from_chars_threshold;
+    const integer huge = -(pow(integer(3), integer(20000)) + 12345);      // about 31700 bits
+    for(integer::REP_SIZE_T t : {threshold, (integer::REP_SIZE_T) 0}){
+        integer::from_chars_threshold = t;
+        for(int base : {3, 10}){
+            const std::string digits = huge.str(base);
+            result = from_chars(digits.data(), digits.data() + digits.size(), value, base);
+            EXPECT_EQ(result.ec, std::errc());
+            EXPECT_EQ(result.ptr, digits.data() + digits.size());
+            EXPECT_EQ(value, huge);
+        }
+    }
+    integer::from_chars_threshold = threshold;
+}
+
+TEST(External, bytes){
+    const integer value = -pow(integer(3), integer(700)) - 0x1234;     // 1110 bits
+    const std::string big = makeascii(-value);                          // most significant byte first
+
+    // big endian bytes
+    std::vector <unsigned char> buffer(export_bytes_length(value) + 1, 0xaa);
+    EXPECT_EQ(export_bytes_length(value), big.size());
+    EXPECT_EQ(export_bytes(buffer.data(), value), big.size());
+    EXPECT_EQ(std::string(buffer.begin(), buffer.end() - 1), big);
+    EXPECT_EQ(buffer.back(), 0xaa);
+
+    integer read = 5;
+    import_bytes(read, big.data(), big.size());
+    EXPECT_EQ(read, -value);
+
+    const uint16_t one = 1;
+    const bool little = *reinterpret_cast <const unsigned char *> (&one);
+
+    // every layout, with words that do not line up with digits
+    for(std::size_t size : {1, 2, 3, 4, 7, 8, 9, 16}){
+        const std::size_t count = export_bytes_length(value, size);
+        EXPECT_EQ(count, (big.size() + size - 1) / size);
+
+        // the same bytes, padded to whole words
+        const std::string padded = std::string(count * size - big.size(), '\0') + big;
+
+        for(int endian : {1, -1, 0}){
+            for(int order : {1, -1}){
+                std::vector <unsigned char> out(count * size);
+                EXPECT_EQ(export_bytes(out.data(), value, size, endian, order), count);
+
+                // rebuild the big endian string from the words
+                std::string check;
+                for(std::size_t w = 0; w < count; w++){
+                    const std::size_t word = (order == 1)?w:(count - 1 - w);
+                    std::string bytes(out.begin() + word * size, out.begin() + (word + 1) * size);
+                    if ((endian == -1) || ((endian == 0) && little)){
+                        std::reverse(bytes.begin(), bytes.end());
+                    }
+                    check += bytes;
+                }
+                EXPECT_EQ(check, padded);
+
+                integer in;
+                import_bytes(in, out.data(), count, size, endian, order);
+                EXPECT_EQ(in, -value);
+            }
+        }
+    }
+
+    // zero
+    EXPECT_EQ(export_bytes_length(integer(0), 4), 0);
+    EXPECT_EQ(export_bytes(buffer.data(), integer(0), 4), 0);
+    import_bytes(read, buffer.data(), 0, 4);
+    EXPECT_EQ(read, 0);
+
+    // leading zero words are dropped
+    const unsigned char zeros[] = {0, 0, 0, 0, 0, 1, 0, 2};
+    import_bytes(read, zeros, 4, 2, 1, 1);
+    EXPECT_EQ(read, 0x10002);
+
+    EXPECT_THROW(export_bytes_length(value, 0), std::runtime_error);
+    EXPECT_THROW(import_bytes(read, zeros, 1, 0), std::runtime_error);
+}
+
+TEST(External, serialize){
+    std::vector <unsigned char> bytes;
+
+    // small values are stored in the header
+    const std::map <int, std::vector <unsigned char> > small = {
+        {0,     {0x02}},
+        {5,     {0x16}},
+        {-1,    {0x07}},
+        {31,    {0x7e}},
+        {-31,   {0x7f}},
+        {300,   {0xb2, 0x09}},
+        {4095,  {0xfe, 0x7f}},
+        {65536, {0x82, 0x80, 0x10}},
+    };
+    for(auto t : small){
+        bytes.clear();
+        serialize(integer(t.first), std::back_inserter(bytes));
+        EXPECT_EQ(bytes, t.second);
+        EXPECT_EQ(serialized_size(integer(t.first)), t.second.size());
+    }
+
+    // larger values are followed by their bytes
+    bytes.clear();
+    serialize(-(integer(1) << 64), std::back_inserter(bytes));
+    EXPECT_EQ(bytes, std::vector <unsigned char> ({0x25, 0, 0, 0, 0, 0, 0, 0, 0, 1}));
+
+    // values written back to back
+    std::vector <integer> values = {0, 1, -1, 4096, integer(1) << 62, -(integer(1) << 63), pow(integer(7), integer(900)), -pow(integer(3), integer(5000))};
+    for(int i = 0; i < 200; i++){
+        values.push_back((i & 1)?(values.back() * 37 + i):-(values.back() >> 3));
+    }
+
+    bytes.clear();
+    std::size_t size = 0;
+    for(const integer & value : values){
+        serialize(value, std::back_inserter(bytes));
+        size += serialized_size(value);
+    }
+    EXPECT_EQ(bytes.size(), size);
+
+    std::vector <unsigned char>::const_iterator it = bytes.begin();
+    for(const integer & value : values){
+        integer read = 12345;
+        it = deserialize(it, bytes.cend(), read);
+        EXPECT_EQ(read, value);
+    }
+    EXPECT_EQ(it, bytes.cend());
+
+    // through streams
+    std::stringstream stream;
+    serialize(values.back(), std::ostreambuf_iterator <char> (stream));
+    integer read;
+    deserialize(std::istreambuf_iterator <char> (stream), std::istreambuf_iterator <char> (), read);
+    EXPECT_EQ(read, values.back());
+
+    // malformed input
+    const unsigned char truncated[] = {0x0c, 0x00, 0x00};
+    EXPECT_THROW(deserialize(truncated, truncated + 3, read), std::runtime_error);
+    EXPECT_THROW(deserialize(truncated, truncated, read), std::runtime_error);
+    const unsigned char header[] = {0x80, 0x80};
+    EXPECT_THROW(deserialize(header, header + 2, read), std::runtime_error);
+    const unsigned char overflow[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f};
+    EXPECT_THROW(deserialize(overflow, overflow + 10, read), std::runtime_error);
+    const unsigned char version[] = {0x01, 0x02};
+    EXPECT_THROW(deserialize(version, version + 2, read), std::runtime_error);
+
+    // errors leave the value alone
+    read = -pow(integer(3), integer(300));
+    const integer before = read;
+    const unsigned char short_input[] = {0x21, 0x11, 0x22};             // negative, 8 bytes
+    EXPECT_THROW(deserialize(short_input, short_input + 3, read), std::runtime_error);
+    EXPECT_EQ(read, before);
+    EXPECT_THROW(deserialize(header, header + 2, read), std::runtime_error);
+    EXPECT_EQ(read, before);
+}
+
 TEST(Miscellaneous, abs){
     const integer pos("12345", 16);
     const integer neg = -pos;
@@ -251,4 +649,62 @@ TEST(Miscellaneous, pow3){
 
     EXPECT_EQ(pow( base,    0,   mod),      1);
     EXPECT_EQ(pow( base,   -1,   mod),      0);
+
+    const barrett_reducer pos( mod);
+    const barrett_reducer neg(-mod);
+
+    EXPECT_EQ(pow( base,  exp,  pos),  result);
+    EXPECT_EQ(pow(-base,  exp,  pos), -result);
+    EXPECT_EQ(pow( base,  exp,  neg),  result);
+    EXPECT_EQ(pow(-base,  exp,  neg), -result);
+
+    EXPECT_EQ(pow( base,    0,  pos),       1);
+    EXPECT_EQ(pow( base,   -1,  pos),       0);
+
+    // odd moduli use Montgomery multiplication
+    const integer odd   ("1235", 10);
+    const integer oddres("48",   10);
+    const montgomery_context context(odd);
+
+    EXPECT_EQ(pow( base,  exp,  odd),  oddres);
+    EXPECT_EQ(pow(-base,  exp,  odd), -oddres);
+    EXPECT_EQ(pow( base,  exp, -odd),  oddres);
+    EXPECT_EQ(pow(-base,  exp, -odd), -oddres);
+    EXPECT_EQ(pow( base,  exp,  context),  oddres);
+    EXPECT_EQ(pow(-base,  exp,  context), -oddres);
+
+    EXPECT_EQ(pow( base,    0,  odd),       1);
+    EXPECT_EQ(pow( base,   -1,  odd),       0);
+    EXPECT_EQ(pow( base,    0,  context),   1);
+    EXPECT_EQ(pow( base,   -1,  context),   0);
+
+    // large modulus
+    const integer big = (integer(1) << 521) - 1;
+    EXPECT_EQ(pow(base, big - 1, barrett_reducer(big)),    1);
+    EXPECT_EQ(pow(base, big - 1, big),                     1);
+    EXPECT_EQ(pow(base, big - 1, montgomery_context(big)), 1);
+}
+
+TEST(Miscellaneous, pow_fixed_base){
+    const integer base("3",    10);
+    const integer exp ("1001", 10);
+
+    // odd and even moduli with tables long enough for the exponent and too short
+    for(integer const & mod : {integer(1234), integer(-1235), (integer(1) << 521) - 1}){
+        for(integer::REP_SIZE_T bits : {0, 5, 64}){
+            const fixed_base_pow pos( base, mod, bits);
+            const fixed_base_pow neg(-base, mod, bits);
+
+            EXPECT_EQ(pos.pow(exp),  pow( base, exp, mod));
+            EXPECT_EQ(neg.pow(exp),  pow(-base, exp, mod));
+            EXPECT_EQ(pos.pow(exp + 1),  pow( base, exp + 1, mod));
+            EXPECT_EQ(neg.pow(exp + 1),  pow(-base, exp + 1, mod));
+            EXPECT_EQ(pos.pow(63),   pow( base,  63, mod));
+            EXPECT_EQ(pos.pow(1),    pow( base,   1, mod));
+            EXPECT_EQ(pos.pow(0),    1);
+            EXPECT_EQ(pos.pow(-1),   0);
+        }
+    }
+
+    EXPECT_THROW(fixed_base_pow(base, 0), std::domain_error);
 }
@@ -86,4 +86,96 @@ TEST(External, modulo){
     EXPECT_EQ(i16 %= neg, (int16_t)  -0x744);
     EXPECT_EQ(i32 %= neg, (int32_t)  -0x7a7);
     EXPECT_EQ(i64 %= neg, (int64_t)  -0xcc2);
-}
\ No newline at end of file
+}
+
+TEST(Arithmetic, barrett){
+    const integer moduli[] = {
+        1,
+        -7,
+        integer("ffff", 16),
+        integer("fedbca9876543210", 16),
+        -((integer(1) << 200) - 1),
+        integer(1) << 255,
+        (integer(1) << 700) + (integer(1) << 350) + 1,
+    };
+
+    for(integer const & m : moduli){
+        const barrett_reducer reducer(m);
+        EXPECT_EQ(reducer.modulus(), m);
+
+        // values below m^2 and values that fall back to operator%
+        const integer values[] = {
+            0,
+            1,
+            -1,
+            m - 1,
+            m,
+            m * m - 1,
+            -(m * m - 1),
+            (m * m) << 1,
+            integer("123456789abcdef0123456789abcdef0123456789abcdef", 16) << 3000,
+        };
+
+        for(integer const & x : values){
+            EXPECT_EQ(reducer.reduce(x), x % m);
+        }
+    }
+
+    EXPECT_THROW(barrett_reducer(0), std::domain_error);
+}
+
+TEST(Arithmetic, montgomery){
+    const integer::REP_SIZE_T threshold = integer::redc_threshold;
+
+    const integer moduli[] = {
+        1,
+        -7,
+        integer("ffff", 16),
+        integer("fedbca9876543211", 16),
+        -((integer(1) << 200) - 1),
+        (integer(1) << 700) + (integer(1) << 350) + 1,
+    };
+
+    const integer values[] = {
+        0,
+        1,
+        -1,
+        integer("fedbca9876543210", 16),
+        -((integer(1) << 1000) - 1),
+    };
+
+    // a small threshold reduces with products instead of one digit at a time
+    for(integer::REP_SIZE_T redc : {threshold, (integer::REP_SIZE_T) 0}){
+        integer::redc_threshold = redc;
+
+        for(integer const & m : moduli){
+            const montgomery_context context(m);
+            EXPECT_EQ(context.modulus(), m);
+
+            const integer mod = abs(m);
+            for(integer const & x : values){
+                integer expected = x % mod;
+                if (expected < 0){
+                    expected += mod;
+                }
+                EXPECT_EQ(context.from(context.to(x)), expected);
+
+                for(integer const & y : values){
+                    integer product = (x * y) % mod;
+                    if (product < 0){
+                        product += mod;
+                    }
+                    EXPECT_EQ(context.from(context.mult(context.to(x), context.to(y))), product);
+                }
+
+                integer square = (x * x) % mod;
+                EXPECT_EQ(context.from(context.sqr(context.to(x))), square);
+            }
+        }
+    }
+
+    integer::redc_threshold = threshold;
+
+    EXPECT_THROW(montgomery_context(0),    std::domain_error);
+    EXPECT_THROW(montgomery_context(1234), std::domain_error);
+}
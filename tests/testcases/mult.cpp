@@ -85,3 +85,62 @@ TEST(External, multiply){
     EXPECT_EQ(i32 *= neg, (int32_t)  -0x3cd36a00);
     EXPECT_EQ(i64 *= neg, (int64_t)  -0xe2790fa63cd36a00);
 }
+
+// every algorithm should give the same product as long multiplication
+TEST(Arithmetic, multiply_algorithms){
+    const integer::REP_SIZE_T karatsuba = integer::karatsuba_threshold;
+    const integer::REP_SIZE_T toom3     = integer::toom3_threshold;
+    const integer::REP_SIZE_T toom4     = integer::toom4_threshold;
+    const integer::REP_SIZE_T ntt       = integer::ntt_threshold;
+
+    // values with irregular bit patterns of many different sizes
+    std::vector <integer> values;
+    integer value("123456789abcdef0fedcba9876543210", 16);
+    for(int bits = 50; bits < 5000; bits = bits * 3 / 2){
+        value = (value * value) ^ (value << 7);
+        values.push_back((value >> (value.bits() - bits)) | 1);
+    }
+    values.push_back((integer(1) << 3000) - 1);
+    values.push_back(-values[values.size() / 2]);
+
+    const integer::REP_SIZE_T thresholds[][4] = {
+        {0,       0,       0,       0},         // NTT
+        {0,       1 << 30, 1 << 30, 1 << 30},   // Karatsuba
+        {64,      1 << 30, 1 << 30, 1 << 30},   // Karatsuba down to small values
+        {0,       0,       1 << 30, 1 << 30},   // Toom-3
+        {0,       0,       0,       1 << 30},   // Toom-4
+        {200,     500,     1000,    2000},      // everything
+    };
+
+    for(const integer & lhs : values){
+        for(const integer & rhs : values){
+            integer::karatsuba_threshold = 1 << 30;
+            const integer expected = lhs * integer(rhs);    // copy so that squares are not detected
+
+            for(const auto & threshold : thresholds){
+                integer::karatsuba_threshold = threshold[0];
+                integer::toom3_threshold     = threshold[1];
+                integer::toom4_threshold     = threshold[2];
+                integer::ntt_threshold       = threshold[3];
+                EXPECT_EQ(lhs * rhs, expected);
+
+                integer product = lhs;
+                product *= rhs;
+                EXPECT_EQ(product, expected);
+
+                // squaring
+                if (&lhs == &rhs){
+                    EXPECT_EQ(lhs.sqr(), expected);
+                    product = lhs;
+                    product *= product;
+                    EXPECT_EQ(product, expected);
+                }
+            }
+        }
+    }
+
+    integer::karatsuba_threshold = karatsuba;
+    integer::toom3_threshold     = toom3;
+    integer::toom4_threshold     = toom4;
+    integer::ntt_threshold       = ntt;
+}
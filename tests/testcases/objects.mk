@@ -23,4 +23,6 @@ INTEGER_TESTCASES_OBJECTS=constructor.o   \
                           fix.o           \
                           unary.o         \
                           functions.o     \
-                          type_traits.o
\ No newline at end of file
+                          type_traits.o   \
+                          allocation.o    \
+                          view.o
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "integer.h"
+
+TEST(View, accessors){
+    // digits stored outside of any integer, with zeros on top
+    const std::vector <INTEGER_DIGIT_T> digits = {5, 0, 3, 0, 0};
+    const integer value = (integer(3) << (2 * sizeof(INTEGER_DIGIT_T) * 8)) + 5;
+
+    const integer_view view(digits.data(), digits.size());
+    EXPECT_EQ(view.data(), digits.data());
+    EXPECT_EQ(view.digits(), 3);
+    EXPECT_EQ(view.sign(), integer::POSITIVE);
+    EXPECT_EQ(view.bits(), value.bits());
+    EXPECT_TRUE(static_cast <bool> (view));
+    for(integer::REP_SIZE_T i = 0; i < 200; i++){
+        EXPECT_EQ(view[i], value[i]);
+    }
+
+    EXPECT_EQ(integer(view), value);
+    EXPECT_EQ(integer(-view), -value);
+    EXPECT_EQ(integer(integer_view(digits.data(), digits.size(), integer::NEGATIVE)), -value);
+
+    // integers are viewed in place
+    const integer_view same(value);
+    EXPECT_EQ(same.digits(), value.digits());
+    EXPECT_EQ(same, view);
+
+    // zero is never negative
+    const integer_view zero(digits.data() + 3, 2, integer::NEGATIVE);
+    EXPECT_EQ(zero.digits(), 0);
+    EXPECT_EQ(zero.sign(), integer::POSITIVE);
+    EXPECT_EQ((-zero).sign(), integer::POSITIVE);
+    EXPECT_FALSE(static_cast <bool> (zero));
+    EXPECT_FALSE(static_cast <bool> (integer_view()));
+    EXPECT_EQ(integer(zero), 0);
+}
+
+TEST(View, compare){
+    const std::vector <integer> values = {0, 1, -1, 12345, -12345, integer(1) << 200, -(integer(1) << 200), (integer(1) << 200) + 1};
+    for(const integer & a : values){
+        const integer_view va(a);
+        for(const integer & b : values){
+            const integer_view vb(b);
+            EXPECT_EQ(va == vb, a == b);
+            EXPECT_EQ(va != vb, a != b);
+            EXPECT_EQ(va >  vb, a >  b);
+            EXPECT_EQ(va >= vb, a >= b);
+            EXPECT_EQ(va <  vb, a <  b);
+            EXPECT_EQ(va <= vb, a <= b);
+
+            // mixed with integers
+            EXPECT_EQ(va < b, a < b);
+            EXPECT_EQ(a < vb, a < b);
+            EXPECT_EQ(va == b, a == b);
+            EXPECT_EQ(a != vb, a != b);
+        }
+    }
+}
+
+TEST(View, arithmetic){
+    const integer a = pow(integer(3), integer(3000)) + 7;      // about 4750 bits
+    const integer b = pow(integer(7), integer(1000)) - 1;      // about 2800 bits
+    const integer large = pow(integer(5), integer(8000));      // about 18600 bits
+
+    const std::vector <integer> values = {a, -a, b, -b, large, -large, integer(1234567), -integer(89), integer(0)};
+    for(const integer & x : values){
+        const integer_view vx(x);
+        for(const integer & y : values){
+            const integer_view vy(y);
+            EXPECT_EQ(vx * vy, x * y);
+            EXPECT_EQ(vx * y,  x * y);
+            EXPECT_EQ(x * vy,  x * y);
+
+            if (!y){
+                EXPECT_THROW(vx / vy, std::domain_error);
+                EXPECT_THROW(vx % vy, std::domain_error);
+                continue;
+            }
+
+            EXPECT_EQ(vx / vy, x / y);
+            EXPECT_EQ(vx % vy, x % y);
+            EXPECT_EQ(vx / y,  x / y);
+            EXPECT_EQ(x % vy,  x % y);
+
+            const std::pair <integer, integer> qr = divmod(vx, vy);
+            EXPECT_EQ(qr.first,  x / y);
+            EXPECT_EQ(qr.second, x % y);
+        }
+    }
+}
+
+TEST(Span, arithmetic){
+    const integer a = pow(integer(3), integer(3000)) + 7;      // about 4750 bits
+    const integer b = pow(integer(7), integer(1000)) - 1;      // about 2800 bits
+    const integer large = pow(integer(5), integer(8000));      // about 18600 bits
+
+    const std::vector <integer> values = {a, -a, b, -b, large, -large, a + 1, -(a + 1), integer(1234567), -integer(89), integer(0)};
+    for(const integer & x : values){
+        for(const integer & y : values){
+            // caller owned buffers
+            std::vector <INTEGER_DIGIT_T> out(x.digits() + y.digits() + 1, 7), r(y.digits() + 1, 7);
+            const integer_span span(out.data(), out.size());
+
+            const integer_span sum = add(span, x, y);
+            EXPECT_EQ(sum.data(), out.data());
+            EXPECT_EQ(integer(integer_view(sum)), x + y);
+            EXPECT_EQ(integer(integer_view(sub(span, x, y))), x - y);
+            EXPECT_EQ(integer(integer_view(mult(span, x, y))), x * y);
+
+            // integer outputs
+            integer value = 5;
+            EXPECT_EQ(add (value, x, y), x + y);
+            EXPECT_EQ(sub (value, x, y), x - y);
+            EXPECT_EQ(mult(value, x, y), x * y);
+
+            if (!y){
+                EXPECT_THROW(divmod(span, integer_span(r.data(), r.size()), x, y), std::domain_error);
+                EXPECT_THROW(divmod(value, value, x, y), std::domain_error);
+                continue;
+            }
+
+            const std::pair <integer_span, integer_span> qr = divmod(span, integer_span(r.data(), r.size()), x, y);
+            EXPECT_EQ(integer(integer_view(qr.first)),  x / y);
+            EXPECT_EQ(integer(integer_view(qr.second)), x % y);
+
+            integer q, m;
+            divmod(q, m, x, y);
+            EXPECT_EQ(q, x / y);
+            EXPECT_EQ(m, x % y);
+        }
+    }
+}
+
+TEST(Span, in_place){
+    const integer step = pow(integer(3), integer(500));
+
+    // a value kept in a record, updated without copying it
+    std::vector <INTEGER_DIGIT_T> record(step.digits() + 2, 0);
+    integer_span value(record.data(), 0);
+    integer expected = 0;
+    for(int i = 0; i < 50; i++){
+        value = add(integer_span(record.data(), record.size()), value, step);
+        expected += step;
+        value = sub(integer_span(record.data(), record.size()), value, integer(i));
+        expected -= i;
+    }
+    EXPECT_EQ(value.data(), record.data());
+    EXPECT_EQ(integer(integer_view(value)), expected);
+
+    // integers as their own operands
+    integer x = step;
+    add(x, x, x);
+    EXPECT_EQ(x, step * 2);
+    sub(x, step, x);
+    EXPECT_EQ(x, -step);
+    mult(x, x, x);
+    EXPECT_EQ(x, step * step);
+    integer r;
+    divmod(x, r, x, step + 1);
+    EXPECT_EQ(x, (step * step) / (step + 1));
+    EXPECT_EQ(r, (step * step) % (step + 1));
+
+    // too small
+    std::vector <INTEGER_DIGIT_T> small(step.digits());
+    EXPECT_THROW(add (integer_span(small.data(), small.size()), step, step), std::runtime_error);
+    EXPECT_THROW(mult(integer_span(small.data(), small.size()), step, step), std::runtime_error);
+    EXPECT_THROW(divmod(integer_span(small.data(), small.size()), integer_span(small.data(), 1), step, step - 1), std::runtime_error);
+}